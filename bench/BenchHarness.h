@@ -0,0 +1,187 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+// Timing and reporting shared by the benchmarks in this directory.
+//
+// Measure() runs a kernel a few times untimed (warmup), then repeats it
+// until both a minimum count and a minimum total time are reached, and
+// reports the median and 95th percentile of the samples. Kernels faster than
+// kMinSampleSeconds are called several times per sample so the clock
+// resolution does not dominate. BenchReport collects named results with
+// their flop and byte counts, prints a table and writes JSON for tracking
+// regressions between releases.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct BenchOptions {
+    int warmup;            // Untimed runs before sampling (at least one, which sizes the samples)
+    int minRepetitions;    // Samples taken at least...
+    int maxRepetitions;    // ...and at most
+    double minSeconds;     // Keep sampling until this much time was measured
+
+    BenchOptions() : warmup(2), minRepetitions(5), maxRepetitions(200), minSeconds(0.2) {}
+};
+
+struct BenchTiming {
+    int repetitions;       // Samples taken
+    int callsPerSample;    // Kernel calls averaged in each sample
+    double median;         // Seconds per call
+    double p95;
+    double min;
+
+    BenchTiming() : repetitions(0), callsPerSample(1), median(0.0), p95(0.0), min(0.0) {}
+};
+
+// One sample is at least this long; shorter kernels are batched
+const double kMinSampleSeconds = 1e-4;
+
+inline double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Keeps a result alive so the compiler cannot drop the work producing it
+template <typename T>
+inline void KeepAlive(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+template <typename F>
+inline BenchTiming Measure(F kernel, const BenchOptions& options = BenchOptions()) {
+    double warmupSeconds = 0.0;
+    for (int i = 0; i < std::max(1, options.warmup); i++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        kernel();
+        warmupSeconds = SecondsSince(start);
+    }
+
+    BenchTiming timing;
+    if (warmupSeconds < kMinSampleSeconds) {
+        timing.callsPerSample = static_cast<int>(std::min(1e6, std::ceil(kMinSampleSeconds / std::max(warmupSeconds, 1e-9))));
+    }
+    std::vector<double> samples;
+    double total = 0.0;
+    while (static_cast<int>(samples.size()) < options.minRepetitions ||
+           (total < options.minSeconds && static_cast<int>(samples.size()) < options.maxRepetitions)) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int c = 0; c < timing.callsPerSample; c++) kernel();
+        const double seconds = SecondsSince(start);
+        samples.push_back(seconds / timing.callsPerSample);
+        total += seconds;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const std::size_t count = samples.size();
+    timing.repetitions = static_cast<int>(count);
+    timing.median = count % 2 ? samples[count / 2] : 0.5 * (samples[count / 2 - 1] + samples[count / 2]);
+    timing.p95 = samples[std::min(count - 1, static_cast<std::size_t>(std::ceil(0.95 * count)) - 1)];
+    timing.min = samples.front();
+    return timing;
+}
+
+// Median seconds per call, for benchmarks that print their own comparison tables
+template <typename F>
+inline double MedianSeconds(F kernel, const BenchOptions& options = BenchOptions()) {
+    return Measure(kernel, options).median;
+}
+
+inline std::string JsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+struct BenchResult {
+    std::string name;      // Kernel, e.g. "gemm"
+    std::string shape;     // Problem size, e.g. "512x512"
+    long long size;        // Leading dimension of the sweep
+    BenchTiming timing;
+    double flops;          // Floating-point operations per call (0 if not meaningful)
+    double bytes;          // Bytes moved per call (0 if not meaningful)
+};
+
+class BenchReport {
+private:
+    std::vector<std::pair<std::string, std::string> > mContext;
+    std::vector<BenchResult> mResults;
+
+    static std::string Number(double value) {
+        if (!(value > 0.0) || !std::isfinite(value)) return "null";
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.6g", value);
+        return text;
+    }
+
+public:
+    // Adds a key/value pair to the "context" object of the JSON output
+    void SetContext(const std::string& key, const std::string& value) {
+        mContext.push_back(std::make_pair(key, value));
+    }
+
+    // Records a result and prints it as a table row
+    void Add(const std::string& name, const std::string& shape, long long size, const BenchTiming& timing,
+             double flops, double bytes) {
+        BenchResult result = { name, shape, size, timing, flops, bytes };
+        mResults.push_back(result);
+        std::printf("%-22s %-14s %12.4e %12.4e %6d", name.c_str(), shape.c_str(), timing.median, timing.p95,
+                    timing.repetitions);
+        if (flops > 0.0) std::printf(" %10.2f", flops / timing.median * 1e-9);
+        else std::printf(" %10s", "-");
+        if (bytes > 0.0) std::printf(" %10.2f", bytes / timing.median * 1e-9);
+        else std::printf(" %10s", "-");
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+
+    static void PrintHeader() {
+        std::printf("%-22s %-14s %12s %12s %6s %10s %10s\n",
+                    "kernel", "shape", "median(s)", "p95(s)", "reps", "GFLOP/s", "GB/s");
+    }
+
+    // @return false if the file cannot be written
+    bool WriteJson(const std::string& filename) const {
+        std::FILE* file = std::fopen(filename.c_str(), "w");
+        if (!file) return false;
+        std::fprintf(file, "{\n  \"context\": {");
+        for (std::size_t i = 0; i < mContext.size(); i++) {
+            std::fprintf(file, "%s\n    \"%s\": \"%s\"", i ? "," : "", JsonEscape(mContext[i].first).c_str(),
+                         JsonEscape(mContext[i].second).c_str());
+        }
+        std::fprintf(file, "\n  },\n  \"results\": [");
+        for (std::size_t i = 0; i < mResults.size(); i++) {
+            const BenchResult& r = mResults[i];
+            std::fprintf(file,
+                         "%s\n    {\"name\": \"%s\", \"shape\": \"%s\", \"size\": %lld, \"repetitions\": %d, "
+                         "\"calls_per_sample\": %d, \"median_s\": %.6e, \"p95_s\": %.6e, \"min_s\": %.6e, "
+                         "\"gflops\": %s, \"gbps\": %s}",
+                         i ? "," : "", JsonEscape(r.name).c_str(), JsonEscape(r.shape).c_str(), r.size,
+                         r.timing.repetitions, r.timing.callsPerSample, r.timing.median, r.timing.p95,
+                         r.timing.min, Number(r.flops / r.timing.median * 1e-9).c_str(),
+                         Number(r.bytes / r.timing.median * 1e-9).c_str());
+        }
+        std::fprintf(file, "\n  ]\n}\n");
+        return std::fclose(file) == 0;
+    }
+};
+
+#endif // BENCH_HARNESS_H
@@ -0,0 +1,92 @@
+// Shows the scaling of the LU-based Determinant/Inverse against the old
+// cofactor-expansion versions, and LogDeterminant on sizes where det(A)
+// itself overflows.
+//
+// Usage: DeterminantBench [maxCofactorSize]
+// Cofactor expansion is O(n!), so by default it only runs up to n = 10.
+
+#include "BenchHarness.h"
+#include "Matrix.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+Matrix RandomMatrix(int n, std::mt19937& rng) {
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Matrix m(n, n);
+    for (int i = 1; i <= n; i++) {
+        for (int j = 1; j <= n; j++) m(i, j) = dist(rng);
+        m(i, i) += n;  // Keep it comfortably non-singular
+    }
+    return m;
+}
+
+// The Laplace expansion Matrix::Determinant used before
+double CofactorDeterminant(const Matrix& m) {
+    const int n = m.GetNumRows();
+    if (n == 1) return m(1, 1);
+    if (n == 2) return m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1);
+    double det = 0.0;
+    for (int j = 1; j <= n; j++) {
+        double sign = (j % 2 == 1) ? 1.0 : -1.0;
+        det += sign * m(1, j) * CofactorDeterminant(m.SubMatrix(1, j));
+    }
+    return det;
+}
+
+// The adjugate Matrix::Inverse used before
+Matrix CofactorInverse(const Matrix& m) {
+    const int n = m.GetNumRows();
+    const double det = CofactorDeterminant(m);
+    Matrix adjugate(n, n);
+    for (int i = 1; i <= n; i++) {
+        for (int j = 1; j <= n; j++) {
+            double sign = ((i + j) % 2 == 0) ? 1.0 : -1.0;
+            adjugate(j, i) = sign * CofactorDeterminant(m.SubMatrix(i, j));
+        }
+    }
+    return adjugate * (1.0 / det);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int maxCofactor = argc > 1 ? std::atoi(argv[1]) : 10;
+    std::mt19937 rng(7);
+
+    std::printf("Determinant / Inverse: LU vs cofactor expansion\n");
+    std::printf("%6s %12s %12s %12s %12s %10s\n",
+                "n", "det LU(s)", "det cof(s)", "inv LU(s)", "inv cof(s)", "rel.diff");
+    for (int n = 3; n <= maxCofactor; n++) {
+        Matrix a = RandomMatrix(n, rng);
+        double detLU = 0.0, detCof = 0.0;
+        Matrix invLU, invCof;
+        double tDetLU = MedianSeconds([&]() { detLU = a.Determinant(); });
+        double tDetCof = MedianSeconds([&]() { detCof = CofactorDeterminant(a); });
+        double tInvLU = MedianSeconds([&]() { invLU = a.Inverse(); });
+        double tInvCof = n <= 8 ? MedianSeconds([&]() { invCof = CofactorInverse(a); }) : -1.0;
+        std::printf("%6d %12.3e %12.3e %12.3e ", n, tDetLU, tDetCof, tInvLU);
+        if (tInvCof >= 0.0) std::printf("%12.3e", tInvCof);
+        else std::printf("%12s", "-");
+        std::printf(" %10.2e\n", std::abs(detLU - detCof) / std::abs(detCof));
+        std::fflush(stdout);
+    }
+
+    std::printf("\nLU only (cofactor expansion is intractable here)\n");
+    std::printf("%6s %12s %12s %14s %5s %14s\n", "n", "det(s)", "inv(s)", "det", "sign", "log|det|");
+    for (int n = 16; n <= 1024; n *= 2) {
+        Matrix a = RandomMatrix(n, rng);
+        double det = 0.0, logDet = 0.0;
+        int sign = 0;
+        double tDet = MedianSeconds([&]() { det = a.Determinant(); });
+        double tInv = MedianSeconds([&]() { a.Inverse(); });
+        MedianSeconds([&]() { logDet = a.LogDeterminant(sign); });
+        std::printf("%6d %12.3e %12.3e %14.6e %+5d %14.6f\n", n, tDet, tInv, det, sign, logDet);
+        std::fflush(stdout);
+    }
+    return 0;
+}
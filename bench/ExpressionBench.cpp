@@ -0,0 +1,112 @@
+// Compares the fused expression-template evaluation of vector and matrix
+// arithmetic with the old one-operator-at-a-time evaluation, which built a
+// temporary for every intermediate result.
+//
+// Usage: ExpressionBench
+
+#include "BenchHarness.h"
+#include "Matrix.h"
+#include "Vector.h"
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+void FillRandom(Vector& v, std::mt19937& rng) {
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (int i = 0; i < v.GetSize(); i++) v[i] = dist(rng);
+}
+
+void FillRandom(Matrix& m, std::mt19937& rng) {
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (int i = 0; i < m.GetNumRows(); i++) {
+        double* row = m.GetData() + static_cast<std::size_t>(i) * m.GetStride();
+        for (int j = 0; j < m.GetNumCols(); j++) row[j] = dist(rng);
+    }
+}
+
+double MaxDiff(const Vector& a, const Vector& b) {
+    double diff = 0.0;
+    for (int i = 0; i < a.GetSize(); i++) diff = std::max(diff, std::abs(a[i] - b[i]));
+    return diff;
+}
+
+double MaxDiff(const Matrix& a, const Matrix& b) {
+    double diff = 0.0;
+    for (int i = 1; i <= a.GetNumRows(); i++)
+        for (int j = 1; j <= a.GetNumCols(); j++)
+            diff = std::max(diff, std::abs(a(i, j) - b(i, j)));
+    return diff;
+}
+
+void Report(const char* name, int n, double bytes, double tFused, double tEager, double diff) {
+    std::printf("%-22s %9d %12.6f %8.2f %12.6f %8.2f %8.1fx %10.2e\n", name, n,
+                tFused, bytes / tFused * 1e-9, tEager, bytes / tEager * 1e-9, tEager / tFused, diff);
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(42);
+
+    // GB/s counts the minimum traffic of the fused loop: each operand read
+    // once and the result written once
+    std::printf("%-22s %9s %12s %8s %12s %8s %9s %10s\n",
+                "expression", "n", "fused(s)", "GB/s", "eager(s)", "GB/s", "speedup", "max|diff|");
+
+    for (int n = 1000; n <= 10000000; n *= 100) {
+        Vector z(n), p(n), fused(n), eager(n);
+        FillRandom(z, rng);
+        FillRandom(p, rng);
+        const double beta = 0.75;
+
+        // The CG direction update p = z + beta * p
+        double tFused = MedianSeconds([&]() { fused = z + beta * p; });
+        double tEager = MedianSeconds([&]() {
+            Vector scaled(p);
+            scaled *= beta;
+            Vector sum(z);
+            sum += scaled;
+            eager = sum;
+        });
+        Report("z + beta*p", n, 3.0 * 8.0 * n, tFused, tEager, MaxDiff(fused, eager));
+
+        Vector a(n), b(n), c(n);
+        FillRandom(a, rng);
+        FillRandom(b, rng);
+        FillRandom(c, rng);
+        tFused = MedianSeconds([&]() { fused = a + 2.0 * b - 0.5 * c; });
+        tEager = MedianSeconds([&]() {
+            Vector b2(b);
+            b2 *= 2.0;
+            Vector sum(a);
+            sum += b2;
+            Vector c2(c);
+            c2 *= 0.5;
+            sum -= c2;
+            eager = sum;
+        });
+        Report("a + 2b - c/2", n, 4.0 * 8.0 * n, tFused, tEager, MaxDiff(fused, eager));
+    }
+
+    for (int n = 64; n <= 2048; n *= 4) {
+        Matrix A(n, n), B(n, n), C(n, n), fused(n, n), eager(n, n);
+        FillRandom(A, rng);
+        FillRandom(B, rng);
+        FillRandom(C, rng);
+        double tFused = MedianSeconds([&]() { fused = A + 2.0 * B - C; });
+        double tEager = MedianSeconds([&]() {
+            Matrix B2(B);
+            B2 *= 2.0;
+            Matrix sum(A);
+            sum += B2;
+            sum -= C;
+            eager = sum;
+        });
+        Report("A + 2B - C", n, 4.0 * 8.0 * n * n, tFused, tEager, MaxDiff(fused, eager));
+    }
+    return 0;
+}
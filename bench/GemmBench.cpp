@@ -0,0 +1,83 @@
+// Compares the blocked GEMM behind Matrix::operator* with the original
+// i-j-k triple loop for square sizes 64..4096.
+//
+// Usage: GemmBench [maxReferenceSize]
+// The naive loop needs minutes at 4096, so by default it only runs up to 1024.
+
+#include "BenchHarness.h"
+#include "Matrix.h"
+#include "Gemm.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+void FillRandom(Matrix& m, std::mt19937& rng) {
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (int i = 0; i < m.GetNumRows(); i++) {
+        double* row = m.GetData() + static_cast<std::size_t>(i) * m.GetStride();
+        for (int j = 0; j < m.GetNumCols(); j++) row[j] = dist(rng);
+    }
+}
+
+// The loop Matrix::operator* used before the blocked kernel
+void NaiveMultiply(const Matrix& a, const Matrix& b, Matrix& c) {
+    const int m = a.GetNumRows(), n = b.GetNumCols(), k = a.GetNumCols();
+    const double* A = a.GetData();
+    const double* B = b.GetData();
+    double* C = c.GetData();
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            double sum = 0.0;
+            for (int p = 0; p < k; p++) {
+                sum += A[static_cast<std::size_t>(i) * a.GetStride() + p] *
+                       B[static_cast<std::size_t>(p) * b.GetStride() + j];
+            }
+            C[static_cast<std::size_t>(i) * c.GetStride() + j] = sum;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int maxReference = argc > 1 ? std::atoi(argv[1]) : 1024;
+    std::mt19937 rng(42);
+    // The large sizes take seconds per product; three samples are enough
+    BenchOptions options;
+    options.warmup = 1;
+    options.minRepetitions = 3;
+
+    std::printf("GEMM kernel: %s\n", GemmKernelName());
+    std::printf("%6s %12s %10s %12s %10s %9s %10s\n",
+                "n", "blocked(s)", "GFLOP/s", "naive(s)", "GFLOP/s", "speedup", "max|diff|");
+
+    for (int n = 64; n <= 4096; n *= 2) {
+        Matrix a(n, n), b(n, n);
+        FillRandom(a, rng);
+        FillRandom(b, rng);
+        const double flops = 2.0 * n * n * n;
+
+        Matrix blocked;
+        double tBlocked = MedianSeconds([&]() { blocked = a * b; }, options);
+        std::printf("%6d %12.5f %10.2f", n, tBlocked, flops / tBlocked * 1e-9);
+
+        if (n <= maxReference) {
+            Matrix naive(n, n);
+            double tNaive = MedianSeconds([&]() { NaiveMultiply(a, b, naive); }, options);
+            double maxDiff = 0.0;
+            for (int i = 1; i <= n; i++)
+                for (int j = 1; j <= n; j++)
+                    maxDiff = std::max(maxDiff, std::abs(blocked(i, j) - naive(i, j)));
+            std::printf(" %12.5f %10.2f %8.1fx %10.2e\n",
+                        tNaive, flops / tNaive * 1e-9, tNaive / tBlocked, maxDiff);
+        } else {
+            std::printf(" %12s %10s %9s %10s\n", "-", "-", "-", "-");
+        }
+        std::fflush(stdout);
+    }
+    return 0;
+}
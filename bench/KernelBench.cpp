@@ -0,0 +1,331 @@
+// Benchmark suite over the library's kernels, for tracking performance
+// between releases: vector arithmetic, matrix-vector and matrix-matrix
+// products, transpose, determinant and inverse, the dense and positive
+// definite solvers, the pseudo-inverse, CSV parsing, the end-to-end
+// regression and its fixed-size and dynamic solves, each across a sweep of
+// sizes. Every result reports the median
+// and 95th percentile time per call and, where the work is well defined,
+// GFLOP/s or GB/s.
+//
+// Usage: KernelBench [--quick] [--json FILE] [--data FILE] [FILTER]
+//   --quick   smaller sweeps and shorter sampling (for smoke runs)
+//   --json    write the results as JSON to FILE
+//   --data    CSV for the parsing and regression benchmarks (default data/machine.data)
+//   FILTER    only run kernels whose name contains this text
+
+#include "BenchHarness.h"
+#include "FixedRegression.h"
+#include "Gemm.h"
+#include "HardwareDataset.h"
+#include "LinearSystem.h"
+#include "Matrix.h"
+#include "PosSymLinSystem.h"
+#include "RegressionAccumulator.h"
+#include "ThreadPool.h"
+#include "Vector.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct SuiteOptions {
+    bool quick;
+    std::string jsonFile;
+    std::string dataFile;
+    std::string filter;
+
+    SuiteOptions() : quick(false), jsonFile(), dataFile("data/machine.data"), filter() {}
+};
+
+class Suite {
+private:
+    SuiteOptions mOptions;
+    BenchOptions mTiming;
+    BenchReport mReport;
+    std::mt19937 mRng;
+
+    bool Selected(const std::string& name) const {
+        return mOptions.filter.empty() || name.find(mOptions.filter) != std::string::npos;
+    }
+
+    // Sizes from first to last, doubling; --quick stops at quickLast
+    std::vector<int> Sweep(int first, int last, int quickLast) const {
+        std::vector<int> sizes;
+        for (int n = first; n <= (mOptions.quick ? quickLast : last); n *= 2) sizes.push_back(n);
+        return sizes;
+    }
+
+    static std::string Shape(long long rows, long long cols) {
+        std::ostringstream text;
+        text << rows << "x" << cols;
+        return text.str();
+    }
+
+    template <typename F>
+    void Run(const std::string& name, const std::string& shape, long long size, double flops, double bytes, F kernel) {
+        mReport.Add(name, shape, size, Measure(kernel, mTiming), flops, bytes);
+    }
+
+    Vector RandomVector(int n) {
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        Vector v(n);
+        for (int i = 0; i < n; i++) v[i] = dist(mRng);
+        return v;
+    }
+
+    Matrix RandomMatrix(int rows, int cols) {
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        Matrix m(rows, cols);
+        for (int i = 0; i < rows; i++) {
+            double* row = m.GetData() + static_cast<std::size_t>(i) * m.GetStride();
+            for (int j = 0; j < cols; j++) row[j] = dist(mRng);
+        }
+        return m;
+    }
+
+    // Random matrix shifted by n on the diagonal: well conditioned, and
+    // symmetric positive definite when symmetric is set
+    Matrix DominantMatrix(int n, bool symmetric) {
+        Matrix m = RandomMatrix(n, n);
+        if (symmetric) {
+            for (int i = 1; i <= n; i++) {
+                for (int j = 1; j < i; j++) m(j, i) = m(i, j);
+            }
+        }
+        for (int i = 1; i <= n; i++) m(i, i) += n;
+        return m;
+    }
+
+public:
+    explicit Suite(const SuiteOptions& options) : mOptions(options), mTiming(), mReport(), mRng(42) {
+        if (options.quick) {
+            mTiming.warmup = 1;
+            mTiming.minRepetitions = 3;
+            mTiming.minSeconds = 0.05;
+        }
+        mReport.SetContext("suite", "KernelBench");
+        mReport.SetContext("compiler", __VERSION__);
+        mReport.SetContext("gemm_kernel", GemmKernelName());
+        std::ostringstream threads;
+        threads << ThreadPool::Global().GetNumThreads();
+        mReport.SetContext("threads", threads.str());
+        mReport.SetContext("mode", options.quick ? "quick" : "full");
+    }
+
+    void VectorOps() {
+        for (int n : Sweep(1024, 1 << 22, 1 << 16)) {
+            Vector x = RandomVector(n), y = RandomVector(n), z(n);
+            const double bytes = 8.0 * n;
+            if (Selected("vector_axpy")) {
+                Run("vector_axpy", Shape(n, 1), n, 2.0 * n, 3.0 * bytes, [&]() { y = 0.5 * x + y; KeepAlive(y); });
+            }
+            if (Selected("vector_fused")) {
+                // z = x + a y - b x: one pass instead of three temporaries
+                Run("vector_fused", Shape(n, 1), n, 4.0 * n, 3.0 * bytes,
+                    [&]() { z = x + 0.25 * y - 0.5 * x; KeepAlive(z); });
+            }
+            if (Selected("vector_dot")) {
+                double dot = 0.0;
+                Run("vector_dot", Shape(n, 1), n, 2.0 * n, 2.0 * bytes, [&]() { dot = x * y; KeepAlive(dot); });
+            }
+        }
+    }
+
+    void MatrixVector() {
+        if (!Selected("matvec")) return;
+        for (int n : Sweep(64, 4096, 512)) {
+            Matrix A = RandomMatrix(n, n);
+            Vector x = RandomVector(n), y(n);
+            const double elements = static_cast<double>(n) * n;
+            Run("matvec", Shape(n, n), n, 2.0 * elements, 8.0 * (elements + 2.0 * n),
+                [&]() { A.Multiply(x, y); KeepAlive(y); });
+            Run("matvec_transpose", Shape(n, n), n, 2.0 * elements, 8.0 * (elements + 2.0 * n),
+                [&]() { A.MultiplyTranspose(x, y); KeepAlive(y); });
+        }
+    }
+
+    void Gemm() {
+        if (!Selected("gemm")) return;
+        for (int n : Sweep(64, 2048, 256)) {
+            Matrix A = RandomMatrix(n, n), B = RandomMatrix(n, n), C;
+            Run("gemm", Shape(n, n), n, 2.0 * n * n * n, 0.0, [&]() { C = A * B; KeepAlive(C); });
+        }
+    }
+
+    void Transpose() {
+        if (!Selected("transpose")) return;
+        for (int n : Sweep(64, 4096, 512)) {
+            Matrix A = RandomMatrix(n, n), T;
+            Run("transpose", Shape(n, n), n, 0.0, 16.0 * n * n, [&]() { T = A.Transpose(); KeepAlive(T); });
+        }
+    }
+
+    void DeterminantInverse() {
+        for (int n : Sweep(16, 1024, 128)) {
+            Matrix A = DominantMatrix(n, false);
+            const double cube = static_cast<double>(n) * n * n;
+            if (Selected("determinant")) {
+                double det = 0.0;
+                Run("determinant", Shape(n, n), n, 2.0 / 3.0 * cube, 0.0, [&]() { det = A.Determinant(); KeepAlive(det); });
+            }
+            if (Selected("inverse")) {
+                Matrix inverse;
+                Run("inverse", Shape(n, n), n, 2.0 * cube, 0.0, [&]() { inverse = A.Inverse(); KeepAlive(inverse); });
+            }
+        }
+    }
+
+    // Construction and solve together: both systems factorize on first use
+    void Solvers() {
+        for (int n : Sweep(16, 2048, 256)) {
+            const double cube = static_cast<double>(n) * n * n;
+            const double square = static_cast<double>(n) * n;
+            Vector b = RandomVector(n), x;
+            if (Selected("linear_system_solve")) {
+                Matrix A = DominantMatrix(n, false);
+                Run("linear_system_solve", Shape(n, n), n, 2.0 / 3.0 * cube + 2.0 * square, 0.0,
+                    [&]() { x = LinearSystem(A, b).Solve(); KeepAlive(x); });
+            }
+            if (Selected("pos_sym_solve")) {
+                Matrix S = DominantMatrix(n, true);
+                Run("pos_sym_solve", Shape(n, n), n, 1.0 / 3.0 * cube + 2.0 * square, 0.0,
+                    [&]() { x = PosSymLinSystem(S, b).Solve(); KeepAlive(x); });
+            }
+        }
+    }
+
+    // Tall 2n x n matrices, the least-squares shape; the SVD's flop count
+    // depends on convergence, so only times are reported
+    void PseudoInverse() {
+        if (!Selected("pseudo_inverse")) return;
+        for (int n : Sweep(16, 256, 64)) {
+            Matrix A = RandomMatrix(2 * n, n), P;
+            Run("pseudo_inverse", Shape(2 * n, n), n, 0.0, 0.0, [&]() { P = A.PseudoInverse(); KeepAlive(P); });
+        }
+    }
+
+    // Parsing throughput of the CSV in GB/s; the cache is never written here
+    void ReadData() {
+        if (!Selected("read_csv") && !Selected("regression_end_to_end")) return;
+        std::FILE* probe = std::fopen(mOptions.dataFile.c_str(), "rb");
+        if (!probe) {
+            std::printf("%-22s skipped: cannot open %s\n", "read_csv", mOptions.dataFile.c_str());
+            return;
+        }
+        std::fclose(probe);
+
+        ParseStats stats;
+        HardwareDataset data = HardwareDataset::ReadCsv(mOptions.dataFile, &stats);
+        const std::string shape = Shape(data.GetNumRows(), kNumHardwareFields);
+        if (Selected("read_csv")) {
+            Run("read_csv", shape, data.GetNumRows(), 0.0, static_cast<double>(stats.bytes),
+                [&]() { HardwareDataset parsed = HardwareDataset::ReadCsv(mOptions.dataFile); KeepAlive(parsed); });
+        }
+
+        // Parse, stream all rows into the QR factor and fit PRP and ERP
+        if (Selected("regression_end_to_end")) {
+            Run("regression_end_to_end", shape, data.GetNumRows(), 0.0, static_cast<double>(stats.bytes), [&]() {
+                HardwareDataset parsed = HardwareDataset::ReadCsv(mOptions.dataFile);
+                std::vector<int> rows(parsed.GetNumRows());
+                for (int i = 0; i < parsed.GetNumRows(); i++) rows[i] = i;
+                RegressionAccumulator accumulator(kPRP, 2);
+                accumulator.AddRows(parsed.CreateDesignMatrix(rows), parsed.CreateTargetMatrix(rows));
+                Vector rmse = accumulator.RootMeanSquaredError(accumulator.Solve());
+                KeepAlive(rmse);
+            });
+        }
+    }
+
+    // The streaming regression alone on synthetic rows of the dataset's
+    // width, where the real file is too small to show throughput
+    void Regression() {
+        if (Selected("regression_accumulate")) {
+            for (int m : Sweep(1 << 12, 1 << 20, 1 << 14)) {
+                Matrix X = RandomMatrix(m, kPRP), Y = RandomMatrix(m, 2);
+                // Per row, each of the kPRP reflectors takes a norm and a dot plus an
+                // update for every later column of [X | Y]
+                const int laterColumns = kPRP * (kPRP + 1) - kPRP * (kPRP - 1) / 2;
+                const double flops = m * (2.0 * (kPRP + 2) + 4.0 * laterColumns);
+                Run("regression_accumulate", Shape(m, kPRP), m, flops, 8.0 * m * (kPRP + 2), [&]() {
+                    RegressionAccumulator accumulator(kPRP, 2);
+                    accumulator.AddRows(X, Y);
+                    Matrix coefficients = accumulator.Solve();
+                    KeepAlive(coefficients);
+                });
+            }
+        }
+
+        // The back substitution of a fitted accumulator alone, with dynamic
+        // matrices and with the fixed-size kernels that do not allocate
+        if (Selected("regression_solve")) {
+            RegressionAccumulator accumulator(kPRP, 2);
+            accumulator.AddRows(RandomMatrix(4096, kPRP), RandomMatrix(4096, 2));
+            const double flops = 2.0 * kPRP * kPRP;
+            Run("regression_solve", Shape(kPRP, 2), kPRP, flops, 0.0, [&]() {
+                Matrix coefficients = accumulator.Solve();
+                KeepAlive(coefficients);
+            });
+            Run("regression_solve_fixed", Shape(kPRP, 2), kPRP, flops, 0.0, [&]() {
+                FixedMatrix<kPRP, 2> coefficients = SolveFixed<kPRP, 2>(accumulator);
+                KeepAlive(coefficients);
+            });
+        }
+    }
+
+    void RunAll() {
+        BenchReport::PrintHeader();
+        VectorOps();
+        MatrixVector();
+        Gemm();
+        Transpose();
+        DeterminantInverse();
+        Solvers();
+        PseudoInverse();
+        ReadData();
+        Regression();
+    }
+
+    // @throws std::runtime_error if the file cannot be written
+    void WriteJson() const {
+        if (mOptions.jsonFile.empty()) return;
+        if (!mReport.WriteJson(mOptions.jsonFile)) {
+            throw std::runtime_error("Cannot write " + mOptions.jsonFile);
+        }
+        std::printf("Results written to %s\n", mOptions.jsonFile.c_str());
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    SuiteOptions options;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            options.quick = true;
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            options.jsonFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--data") == 0 && i + 1 < argc) {
+            options.dataFile = argv[++i];
+        } else if (argv[i][0] == '-') {
+            std::fprintf(stderr, "Usage: %s [--quick] [--json FILE] [--data FILE] [FILTER]\n", argv[0]);
+            return 2;
+        } else {
+            options.filter = argv[i];
+        }
+    }
+
+    try {
+        Suite suite(options);
+        suite.RunAll();
+        suite.WriteJson();
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,21 @@
+#ifndef ALIGNED_MEMORY_H
+#define ALIGNED_MEMORY_H
+
+#include <cstddef>
+
+// Alignment used for all dense numeric buffers (one cache line, also wide
+// enough for any AVX/AVX-512 load).
+const std::size_t kMemoryAlignment = 64;
+
+// Allocates `bytes` bytes aligned to `alignment` (a power of two).
+// Throws std::bad_alloc on failure. Zero-byte requests return nullptr.
+void* AllocateAligned(std::size_t bytes, std::size_t alignment = kMemoryAlignment);
+
+// Releases memory obtained from AllocateAligned. Accepts nullptr.
+void FreeAligned(void* ptr);
+
+// Rounds a row length (in elements of `elementSize` bytes) up so that every
+// row of a row-major buffer starts on an aligned boundary.
+int PaddedStride(int numCols, std::size_t elementSize);
+
+#endif // ALIGNED_MEMORY_H
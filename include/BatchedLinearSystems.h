@@ -0,0 +1,77 @@
+#ifndef BATCHED_LINEAR_SYSTEMS_H
+#define BATCHED_LINEAR_SYSTEMS_H
+
+#include "Matrix.h"
+#include "Vector.h"
+#include <vector>
+
+/**
+ * Many independent n x n systems A_s x_s = b_s of the same small size,
+ * factorized and solved together.
+ *
+ * The systems are interleaved in blocks of kLanes (structure of arrays
+ * within a block): with s = kLanes * block + lane, element (i, j) of system
+ * s is at GetMatrixData()[(block * n * n + i * n + j) * kLanes + lane] and
+ * element i of its right-hand side at GetRhsData()[(block * n + i) * kLanes
+ * + lane] (all 0-based). Each arithmetic step then runs over kLanes
+ * consecutive systems, so SIMD lanes span systems instead of the few
+ * elements of one tiny row, and one block stays within a few pages. Blocks
+ * are spread over the thread pool, and the kernels use AVX2 when the CPU
+ * supports it (detected at runtime).
+ *
+ * Solving overwrites the matrices with their factors and the right-hand
+ * sides with the solutions. A system that is singular (LU) or not positive
+ * definite (Cholesky) does not stop the batch: it is reported by IsSolved()
+ * and its solution is NaN.
+ */
+class BatchedLinearSystems {
+private:
+    int mSize;
+    int mCount;
+    int mNumBlocks;                      // Blocks of kLanes systems; the last may be padded
+    double* mpMatrices;
+    double* mpRhs;
+    std::vector<unsigned char> mStatus;  // Per system: not solved yet, solved, failed
+
+    void CheckSystem(int system) const;
+    template <typename Kernel>
+    void SolveBlocks(Kernel kernel);
+
+public:
+    static const int kLanes = 8;         // Systems per block handled by one kernel call
+
+    // Zero matrices and right-hand sides for count systems of size n
+    // @throws std::invalid_argument unless both are positive
+    BatchedLinearSystems(int size, int count);
+    ~BatchedLinearSystems();
+
+    BatchedLinearSystems(const BatchedLinearSystems& other) = delete;
+    BatchedLinearSystems& operator=(const BatchedLinearSystems& other) = delete;
+
+    int GetSize() const;
+    int GetCount() const;
+    int GetNumBlocks() const;
+    double* GetMatrixData();
+    const double* GetMatrixData() const;
+    double* GetRhsData();
+    const double* GetRhsData() const;
+
+    // Copies one system into the interleaved layout (system is 0-based)
+    // @throws std::out_of_range / std::invalid_argument on a bad index or shape
+    void SetSystem(int system, const Matrix& A, const Vector& b);
+
+    // LU with partial pivoting, chosen per system
+    void SolveLU();
+    // Cholesky for symmetric positive definite systems; only the lower triangles are read
+    void SolveCholesky();
+
+    bool IsSolved(int system) const;
+    int GetNumFailed() const;
+    // @throws std::runtime_error if the system has not been solved or its solve failed
+    Vector GetSolution(int system) const;
+
+    // "avx2-fma" or "generic"
+    static const char* KernelName();
+};
+
+#endif // BATCHED_LINEAR_SYSTEMS_H
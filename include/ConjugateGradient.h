@@ -0,0 +1,39 @@
+#ifndef CONJUGATE_GRADIENT_H
+#define CONJUGATE_GRADIENT_H
+
+#include "LinearOperator.h"
+#include "Vector.h"
+#include "Preconditioner.h"
+
+struct ConjugateGradientOptions {
+    double relativeTolerance;    // Stop once ||r|| <= relativeTolerance * ||b|| ...
+    double absoluteTolerance;    // ... or ||r|| <= absoluteTolerance
+    int maxIterations;           // 0 selects 2n
+    const Vector* initialGuess;  // Warm start; nullptr starts from zero
+
+    ConjugateGradientOptions()
+        : relativeTolerance(1e-10), absoluteTolerance(0.0), maxIterations(0), initialGuess(nullptr) {}
+};
+
+struct ConjugateGradientResult {
+    Vector solution;
+    int iterations;
+    double residualNorm;         // ||b - Ax|| recomputed for the returned x
+    double relativeResidual;     // residualNorm / ||b||
+    bool converged;
+};
+
+/**
+ * Preconditioned conjugate gradient for a symmetric positive definite A.
+ * Only products A * p are needed, so A may be a dense Matrix or any other
+ * LinearOperator (e.g. NormalOperator for X^T X without forming it).
+ * Never throws for slow convergence: the result reports the iterations
+ * used, the final residual and whether the tolerance was met.
+ * @param preconditioner Approximate inverse of A, or nullptr for plain CG
+ * @throws std::invalid_argument if the dimensions are incompatible
+ */
+ConjugateGradientResult ConjugateGradient(const LinearOperator& A, const Vector& b,
+                                          const ConjugateGradientOptions& options = ConjugateGradientOptions(),
+                                          const Preconditioner* preconditioner = nullptr);
+
+#endif // CONJUGATE_GRADIENT_H
@@ -0,0 +1,85 @@
+#ifndef CROSS_VALIDATION_H
+#define CROSS_VALIDATION_H
+
+#include "Matrix.h"
+#include "RegressionAccumulator.h"
+#include "Vector.h"
+#include <functional>
+#include <random>
+#include <vector>
+
+// One train/test evaluation of a cross-validation run
+struct FoldResult {
+    int repeat;             // 0-based
+    int fold;               // 0-based within the repeat
+    int trainRows;
+    int testRows;
+    Matrix coefficients;    // n x t, fitted on the training rows
+    Vector trainRMSE;       // One per target
+    Vector testRMSE;
+};
+
+struct CrossValidationResult {
+    std::vector<FoldResult> folds;   // Ordered by repeat, then fold
+    Vector meanTrainRMSE;
+    Vector meanTestRMSE;
+    Vector stdDevTestRMSE;           // Sample standard deviation over the folds
+};
+
+/**
+ * Deterministic k-fold and repeated holdout evaluation of least-squares fits.
+ *
+ * Rows are reached only through a RowSource callback that folds a list of
+ * row indices into a RegressionAccumulator, so the data never has to be
+ * materialized. Each row is read once per partition: the test part of every
+ * fold is accumulated, the whole data set is the sum of the folds (or is
+ * accumulated once for repeated holdout), and every training set is obtained
+ * by downdating, i.e. subtracting its test part from the total.
+ *
+ * Shuffles use std::mt19937 with an explicit seed and a portable
+ * Fisher-Yates, so a seed gives the same folds on every platform and thread
+ * count. With strata (e.g. vendor ids) the shuffled rows are ordered stratum
+ * by stratum before being dealt into folds, so every fold draws evenly from
+ * every stratum.
+ */
+class CrossValidation {
+public:
+    // Must be safe to call concurrently from several threads
+    typedef std::function<void(const std::vector<int>& rows, RegressionAccumulator& accumulator)> RowSource;
+
+private:
+    int mNumRows;
+    int mNumFeatures;
+    int mNumTargets;
+    RowSource mSource;
+    std::vector<int> mStrata;   // Empty: one stratum
+
+    std::vector<int> StratifiedOrder(std::mt19937& generator) const;
+    CrossValidationResult Evaluate(const std::vector<std::vector<int> >& testRows,
+                                   const RegressionAccumulator* total, int foldsPerRepeat) const;
+
+public:
+    // @throws std::invalid_argument if a count is not positive
+    CrossValidation(int numRows, int numFeatures, int numTargets, const RowSource& source);
+
+    // One label per row; rows with equal labels form a stratum
+    // @throws std::invalid_argument if the label count differs from the row count
+    void SetStrata(const std::vector<int>& labels);
+
+    /**
+     * Splits the rows into numFolds near-equal folds and fits on every
+     * complement, with the folds evaluated concurrently
+     * @throws std::invalid_argument unless 2 <= numFolds <= rows
+     * @throws std::runtime_error if a training Gram matrix is singular
+     */
+    CrossValidationResult KFold(int numFolds, unsigned int seed) const;
+
+    /**
+     * numRepeats independent random train/test splits
+     * @throws std::invalid_argument unless numRepeats > 0 and both parts are non-empty
+     * @throws std::runtime_error if a training Gram matrix is singular
+     */
+    CrossValidationResult RepeatedHoldout(int numRepeats, double trainRatio, unsigned int seed) const;
+};
+
+#endif // CROSS_VALIDATION_H
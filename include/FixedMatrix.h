@@ -0,0 +1,453 @@
+#ifndef FIXED_MATRIX_H
+#define FIXED_MATRIX_H
+
+#include "FixedVector.h"
+#include "Matrix.h"
+#include "MatrixExpression.h"
+#include <cmath>
+#include <stdexcept>
+
+template <int N>
+struct FixedLU;
+template <int N>
+struct FixedSquareKernels;
+
+/**
+ * R x C matrix of doubles in inline (stack) storage, row-major and without
+ * padding. The dimensions are template arguments, so every loop has a
+ * compile-time trip count and is unrolled; nothing is allocated and
+ * nothing is bounds-checked.
+ *
+ * Determinant() and Inverse() use closed forms for 2x2, 3x3 and 4x4 and
+ * LU with partial pivoting otherwise; Solve() always uses LU.
+ *
+ * Like FixedVector, a FixedMatrix is a matrix expression and converts to a
+ * Matrix; construction from a Matrix is explicit and checks the shape.
+ */
+template <int R, int C>
+class FixedMatrix : public MatrixExpression<FixedMatrix<R, C> > {
+    static_assert(R > 0 && C > 0, "FixedMatrix dimensions must be positive");
+
+private:
+    double mData[R * C];
+
+public:
+    static constexpr int kNumRows = R;
+    static constexpr int kNumCols = C;
+
+    FixedMatrix() {
+        TINYPROJECT_UNROLL
+        for (int k = 0; k < R * C; k++) mData[k] = 0.0;
+    }
+
+    // @throws std::invalid_argument if the expression is not R x C
+    template <typename E>
+    explicit FixedMatrix(const MatrixExpression<E>& expression) {
+        if (expression.GetNumRows() != R || expression.GetNumCols() != C)
+            throw std::invalid_argument("Matrix dimensions do not match the fixed size");
+        TINYPROJECT_UNROLL
+        for (int i = 0; i < R; i++) {
+            TINYPROJECT_UNROLL
+            for (int j = 0; j < C; j++) mData[i * C + j] = expression.Element(i, j);
+        }
+    }
+
+    static FixedMatrix Identity() {
+        static_assert(R == C, "Identity matrix must be square");
+        FixedMatrix result;
+        TINYPROJECT_UNROLL
+        for (int i = 0; i < R; i++) result.mData[i * C + i] = 1.0;
+        return result;
+    }
+
+    int GetNumRows() const { return R; }
+    int GetNumCols() const { return C; }
+    double& operator()(int i, int j) { return mData[(i - 1) * C + (j - 1)]; }   // 1-based, unchecked
+    const double& operator()(int i, int j) const { return mData[(i - 1) * C + (j - 1)]; }
+    double* GetData() { return mData; }              // Row-major, stride C
+    const double* GetData() const { return mData; }
+    double Element(int i, int j) const { return mData[i * C + j]; }
+
+    FixedMatrix& operator+=(const FixedMatrix& other) {
+        TINYPROJECT_UNROLL
+        for (int k = 0; k < R * C; k++) mData[k] += other.mData[k];
+        return *this;
+    }
+
+    FixedMatrix& operator-=(const FixedMatrix& other) {
+        TINYPROJECT_UNROLL
+        for (int k = 0; k < R * C; k++) mData[k] -= other.mData[k];
+        return *this;
+    }
+
+    FixedMatrix& operator*=(double scalar) {
+        TINYPROJECT_UNROLL
+        for (int k = 0; k < R * C; k++) mData[k] *= scalar;
+        return *this;
+    }
+
+    FixedMatrix<C, R> Transpose() const {
+        FixedMatrix<C, R> result;
+        TINYPROJECT_UNROLL
+        for (int i = 0; i < R; i++) {
+            TINYPROJECT_UNROLL
+            for (int j = 0; j < C; j++) result.GetData()[j * R + i] = mData[i * C + j];
+        }
+        return result;
+    }
+
+    double Determinant() const {
+        static_assert(R == C, "Matrix must be square to compute determinant");
+        return FixedSquareKernels<R>::Determinant(mData);
+    }
+
+    // @throws std::runtime_error if the matrix is singular
+    FixedMatrix Inverse() const {
+        static_assert(R == C, "Matrix must be square to compute inverse");
+        FixedMatrix result;
+        if (!FixedSquareKernels<R>::Invert(mData, result.mData))
+            throw std::runtime_error("Matrix is singular (determinant is zero)");
+        return result;
+    }
+
+    // A x = b by LU with partial pivoting
+    // @throws std::runtime_error if the matrix is singular
+    FixedVector<R> Solve(const FixedVector<R>& b) const {
+        static_assert(R == C, "Matrix must be square to solve a linear system");
+        double lu[R * R];
+        int pivots[R];
+        TINYPROJECT_UNROLL
+        for (int k = 0; k < R * R; k++) lu[k] = mData[k];
+        if (!FixedLU<R>::Factor(lu, pivots))
+            throw std::runtime_error("Matrix is singular or nearly singular");
+        FixedVector<R> x(b);
+        FixedLU<R>::Solve(lu, pivots, x.GetData());
+        return x;
+    }
+};
+
+template <int R, int C>
+constexpr int FixedMatrix<R, C>::kNumRows;
+template <int R, int C>
+constexpr int FixedMatrix<R, C>::kNumCols;
+
+template <int R, int C>
+struct MatrixOperand<FixedMatrix<R, C> > {
+    typedef const FixedMatrix<R, C>& Type;
+};
+
+// Arithmetic between fixed matrices stays fixed-size and is evaluated at once
+template <int R, int C>
+inline FixedMatrix<R, C> operator+(const FixedMatrix<R, C>& left, const FixedMatrix<R, C>& right) {
+    FixedMatrix<R, C> result(left);
+    return result += right;
+}
+
+template <int R, int C>
+inline FixedMatrix<R, C> operator-(const FixedMatrix<R, C>& left, const FixedMatrix<R, C>& right) {
+    FixedMatrix<R, C> result(left);
+    return result -= right;
+}
+
+template <int R, int C>
+inline FixedMatrix<R, C> operator-(const FixedMatrix<R, C>& operand) {
+    FixedMatrix<R, C> result(operand);
+    return result *= -1.0;
+}
+
+template <int R, int C>
+inline FixedMatrix<R, C> operator*(double scalar, const FixedMatrix<R, C>& operand) {
+    FixedMatrix<R, C> result(operand);
+    return result *= scalar;
+}
+
+template <int R, int C>
+inline FixedMatrix<R, C> operator*(const FixedMatrix<R, C>& operand, double scalar) {
+    FixedMatrix<R, C> result(operand);
+    return result *= scalar;
+}
+
+template <int R, int K, int C>
+inline FixedMatrix<R, C> operator*(const FixedMatrix<R, K>& left, const FixedMatrix<K, C>& right) {
+    FixedMatrix<R, C> result;
+    const double* a = left.GetData();
+    const double* b = right.GetData();
+    double* c = result.GetData();
+    TINYPROJECT_UNROLL
+    for (int i = 0; i < R; i++) {
+        TINYPROJECT_UNROLL
+        for (int p = 0; p < K; p++) {
+            const double aip = a[i * K + p];
+            TINYPROJECT_UNROLL
+            for (int j = 0; j < C; j++) c[i * C + j] += aip * b[p * C + j];
+        }
+    }
+    return result;
+}
+
+template <int R, int C>
+inline FixedVector<R> operator*(const FixedMatrix<R, C>& left, const FixedVector<C>& right) {
+    FixedVector<R> result;
+    const double* a = left.GetData();
+    TINYPROJECT_UNROLL
+    for (int i = 0; i < R; i++) {
+        double sum = 0.0;
+        TINYPROJECT_UNROLL
+        for (int j = 0; j < C; j++) sum += a[i * C + j] * right[j];
+        result[i] = sum;
+    }
+    return result;
+}
+
+// LU with partial pivoting of a row-major N x N array, in place: L below the
+// diagonal (unit diagonal implied), U on and above it
+template <int N>
+struct FixedLU {
+    // Returns false on an exactly zero pivot
+    static bool Factor(double* a, int* pivots) {
+        TINYPROJECT_UNROLL
+        for (int k = 0; k < N; k++) {
+            int pivot = k;
+            TINYPROJECT_UNROLL
+            for (int i = k + 1; i < N; i++) {
+                if (std::fabs(a[i * N + k]) > std::fabs(a[pivot * N + k])) pivot = i;
+            }
+            pivots[k] = pivot;
+            if (a[pivot * N + k] == 0.0) return false;
+            if (pivot != k) {
+                TINYPROJECT_UNROLL
+                for (int j = 0; j < N; j++) {
+                    const double t = a[k * N + j];
+                    a[k * N + j] = a[pivot * N + j];
+                    a[pivot * N + j] = t;
+                }
+            }
+            const double inversePivot = 1.0 / a[k * N + k];
+            TINYPROJECT_UNROLL
+            for (int i = k + 1; i < N; i++) {
+                const double factor = a[i * N + k] * inversePivot;
+                a[i * N + k] = factor;
+                TINYPROJECT_UNROLL
+                for (int j = k + 1; j < N; j++) a[i * N + j] -= factor * a[k * N + j];
+            }
+        }
+        return true;
+    }
+
+    // Overwrites x = b with the solution of A x = b
+    static void Solve(const double* lu, const int* pivots, double* x) {
+        TINYPROJECT_UNROLL
+        for (int k = 0; k < N; k++) {
+            const double t = x[k];
+            x[k] = x[pivots[k]];
+            x[pivots[k]] = t;
+        }
+        TINYPROJECT_UNROLL
+        for (int i = 1; i < N; i++) {
+            TINYPROJECT_UNROLL
+            for (int j = 0; j < i; j++) x[i] -= lu[i * N + j] * x[j];
+        }
+        TINYPROJECT_UNROLL
+        for (int i = N - 1; i >= 0; i--) {
+            TINYPROJECT_UNROLL
+            for (int j = i + 1; j < N; j++) x[i] -= lu[i * N + j] * x[j];
+            x[i] /= lu[i * N + i];
+        }
+    }
+};
+
+/**
+ * Determinant and inverse of a row-major N x N array. The general case goes
+ * through FixedLU; 2x2, 3x3 and 4x4 are specialized with the cofactor
+ * formulas. Invert returns false for an exactly singular input.
+ */
+template <int N>
+struct FixedSquareKernels {
+    static double Determinant(const double* a) {
+        double lu[N * N];
+        int pivots[N];
+        TINYPROJECT_UNROLL
+        for (int k = 0; k < N * N; k++) lu[k] = a[k];
+        if (!FixedLU<N>::Factor(lu, pivots)) return 0.0;
+        double det = 1.0;
+        TINYPROJECT_UNROLL
+        for (int k = 0; k < N; k++) det *= pivots[k] == k ? lu[k * N + k] : -lu[k * N + k];
+        return det;
+    }
+
+    static bool Invert(const double* a, double* inverse) {
+        double lu[N * N];
+        int pivots[N];
+        TINYPROJECT_UNROLL
+        for (int k = 0; k < N * N; k++) lu[k] = a[k];
+        if (!FixedLU<N>::Factor(lu, pivots)) return false;
+        for (int j = 0; j < N; j++) {
+            double column[N];
+            TINYPROJECT_UNROLL
+            for (int i = 0; i < N; i++) column[i] = i == j ? 1.0 : 0.0;
+            FixedLU<N>::Solve(lu, pivots, column);
+            TINYPROJECT_UNROLL
+            for (int i = 0; i < N; i++) inverse[i * N + j] = column[i];
+        }
+        return true;
+    }
+};
+
+template <>
+struct FixedSquareKernels<2> {
+    static double Determinant(const double* a) { return a[0] * a[3] - a[1] * a[2]; }
+
+    static bool Invert(const double* a, double* inverse) {
+        const double det = Determinant(a);
+        if (det == 0.0) return false;
+        const double s = 1.0 / det;
+        inverse[0] = a[3] * s;
+        inverse[1] = -a[1] * s;
+        inverse[2] = -a[2] * s;
+        inverse[3] = a[0] * s;
+        return true;
+    }
+};
+
+template <>
+struct FixedSquareKernels<3> {
+    static double Determinant(const double* a) {
+        return a[0] * (a[4] * a[8] - a[5] * a[7]) - a[1] * (a[3] * a[8] - a[5] * a[6]) +
+               a[2] * (a[3] * a[7] - a[4] * a[6]);
+    }
+
+    static bool Invert(const double* a, double* inverse) {
+        // Adjugate: transposed cofactors
+        const double c00 = a[4] * a[8] - a[5] * a[7];
+        const double c10 = a[5] * a[6] - a[3] * a[8];
+        const double c20 = a[3] * a[7] - a[4] * a[6];
+        const double det = a[0] * c00 + a[1] * c10 + a[2] * c20;
+        if (det == 0.0) return false;
+        const double s = 1.0 / det;
+        inverse[0] = c00 * s;
+        inverse[1] = (a[2] * a[7] - a[1] * a[8]) * s;
+        inverse[2] = (a[1] * a[5] - a[2] * a[4]) * s;
+        inverse[3] = c10 * s;
+        inverse[4] = (a[0] * a[8] - a[2] * a[6]) * s;
+        inverse[5] = (a[2] * a[3] - a[0] * a[5]) * s;
+        inverse[6] = c20 * s;
+        inverse[7] = (a[1] * a[6] - a[0] * a[7]) * s;
+        inverse[8] = (a[0] * a[4] - a[1] * a[3]) * s;
+        return true;
+    }
+};
+
+template <>
+struct FixedSquareKernels<4> {
+    // 2x2 minors of the top two rows (s) and the bottom two rows (c); the
+    // determinant and every cofactor are sums of their products (Laplace
+    // expansion along the first two rows)
+    struct Minors {
+        double s0, s1, s2, s3, s4, s5;
+        double c0, c1, c2, c3, c4, c5;
+
+        explicit Minors(const double* a) {
+            s0 = a[0] * a[5] - a[4] * a[1];
+            s1 = a[0] * a[6] - a[4] * a[2];
+            s2 = a[0] * a[7] - a[4] * a[3];
+            s3 = a[1] * a[6] - a[5] * a[2];
+            s4 = a[1] * a[7] - a[5] * a[3];
+            s5 = a[2] * a[7] - a[6] * a[3];
+            c5 = a[10] * a[15] - a[14] * a[11];
+            c4 = a[9] * a[15] - a[13] * a[11];
+            c3 = a[9] * a[14] - a[13] * a[10];
+            c2 = a[8] * a[15] - a[12] * a[11];
+            c1 = a[8] * a[14] - a[12] * a[10];
+            c0 = a[8] * a[13] - a[12] * a[9];
+        }
+        double Determinant() const { return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0; }
+    };
+
+    static double Determinant(const double* a) { return Minors(a).Determinant(); }
+
+    static bool Invert(const double* a, double* inverse) {
+        const Minors m(a);
+        const double det = m.Determinant();
+        if (det == 0.0) return false;
+        const double s = 1.0 / det;
+        inverse[0] = (a[5] * m.c5 - a[6] * m.c4 + a[7] * m.c3) * s;
+        inverse[1] = (-a[1] * m.c5 + a[2] * m.c4 - a[3] * m.c3) * s;
+        inverse[2] = (a[13] * m.s5 - a[14] * m.s4 + a[15] * m.s3) * s;
+        inverse[3] = (-a[9] * m.s5 + a[10] * m.s4 - a[11] * m.s3) * s;
+        inverse[4] = (-a[4] * m.c5 + a[6] * m.c2 - a[7] * m.c1) * s;
+        inverse[5] = (a[0] * m.c5 - a[2] * m.c2 + a[3] * m.c1) * s;
+        inverse[6] = (-a[12] * m.s5 + a[14] * m.s2 - a[15] * m.s1) * s;
+        inverse[7] = (a[8] * m.s5 - a[10] * m.s2 + a[11] * m.s1) * s;
+        inverse[8] = (a[4] * m.c4 - a[5] * m.c2 + a[7] * m.c0) * s;
+        inverse[9] = (-a[0] * m.c4 + a[1] * m.c2 - a[3] * m.c0) * s;
+        inverse[10] = (a[12] * m.s4 - a[13] * m.s2 + a[15] * m.s0) * s;
+        inverse[11] = (-a[8] * m.s4 + a[9] * m.s2 - a[11] * m.s0) * s;
+        inverse[12] = (-a[4] * m.c3 + a[5] * m.c1 - a[6] * m.c0) * s;
+        inverse[13] = (a[0] * m.c3 - a[1] * m.c1 + a[2] * m.c0) * s;
+        inverse[14] = (-a[12] * m.s3 + a[13] * m.s1 - a[14] * m.s0) * s;
+        inverse[15] = (a[8] * m.s3 - a[9] * m.s1 + a[10] * m.s0) * s;
+        return true;
+    }
+};
+
+/**
+ * Cholesky factorization A = L L^T of a fixed-size symmetric positive
+ * definite matrix, the stack-storage counterpart of CholeskyFactorization.
+ * Only the lower triangle of A is read.
+ */
+template <int N>
+class FixedCholesky {
+private:
+    double mLower[N * N];
+    bool mIsPositiveDefinite;
+
+public:
+    explicit FixedCholesky(const FixedMatrix<N, N>& A) : mIsPositiveDefinite(true) {
+        const double* a = A.GetData();
+        TINYPROJECT_UNROLL
+        for (int j = 0; j < N; j++) {
+            double diagonal = a[j * N + j];
+            TINYPROJECT_UNROLL
+            for (int k = 0; k < j; k++) diagonal -= mLower[j * N + k] * mLower[j * N + k];
+            if (!(diagonal > 0.0)) {
+                mIsPositiveDefinite = false;
+                return;
+            }
+            const double ljj = std::sqrt(diagonal);
+            mLower[j * N + j] = ljj;
+            const double inverse = 1.0 / ljj;
+            TINYPROJECT_UNROLL
+            for (int i = j + 1; i < N; i++) {
+                double sum = a[i * N + j];
+                TINYPROJECT_UNROLL
+                for (int k = 0; k < j; k++) sum -= mLower[i * N + k] * mLower[j * N + k];
+                mLower[i * N + j] = sum * inverse;
+            }
+        }
+    }
+
+    bool IsPositiveDefinite() const { return mIsPositiveDefinite; }
+
+    // @throws std::runtime_error if the matrix is not positive definite
+    FixedVector<N> Solve(const FixedVector<N>& b) const {
+        if (!mIsPositiveDefinite) throw std::runtime_error("Matrix is not positive definite");
+        FixedVector<N> x(b);
+        TINYPROJECT_UNROLL
+        for (int i = 0; i < N; i++) {
+            double sum = x[i];
+            TINYPROJECT_UNROLL
+            for (int k = 0; k < i; k++) sum -= mLower[i * N + k] * x[k];
+            x[i] = sum / mLower[i * N + i];
+        }
+        TINYPROJECT_UNROLL
+        for (int i = N - 1; i >= 0; i--) {
+            double sum = x[i];
+            TINYPROJECT_UNROLL
+            for (int k = i + 1; k < N; k++) sum -= mLower[k * N + i] * x[k];
+            x[i] = sum / mLower[i * N + i];
+        }
+        return x;
+    }
+};
+
+#endif // FIXED_MATRIX_H
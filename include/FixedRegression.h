@@ -0,0 +1,50 @@
+#ifndef FIXED_REGRESSION_H
+#define FIXED_REGRESSION_H
+
+#include "FixedMatrix.h"
+#include "RegressionAccumulator.h"
+#include <stdexcept>
+
+/**
+ * RegressionAccumulator::Solve() for N features and T targets known at
+ * compile time: the triangular factor is copied into stack storage and
+ * back-substituted with unrolled loops, without allocating.
+ * @throws std::invalid_argument unless N and T match the accumulator
+ * @throws std::runtime_error if the accumulated features are rank deficient
+ */
+template <int N, int T>
+FixedMatrix<N, T> SolveFixed(const RegressionAccumulator& accumulator) {
+    if (N != accumulator.GetNumFeatures() || T != accumulator.GetNumTargets()) {
+        throw std::invalid_argument("Fixed sizes do not match the accumulator");
+    }
+    if (!accumulator.IsFullRank()) {
+        throw std::runtime_error("Features are linearly dependent");
+    }
+    const Matrix& source = accumulator.GetR();
+    const Matrix& d = accumulator.GetRotatedTargets();
+    FixedMatrix<N, N> R;
+    FixedMatrix<N, T> coefficients;
+    double* r = R.GetData();
+    double* b = coefficients.GetData();
+    TINYPROJECT_UNROLL
+    for (int i = 0; i < N; i++) {
+        TINYPROJECT_UNROLL
+        for (int j = i; j < N; j++) r[i * N + j] = source.GetData()[i * source.GetStride() + j];
+        TINYPROJECT_UNROLL
+        for (int k = 0; k < T; k++) b[i * T + k] = d.GetData()[i * d.GetStride() + k];
+    }
+
+    TINYPROJECT_UNROLL
+    for (int i = N - 1; i >= 0; i--) {
+        TINYPROJECT_UNROLL
+        for (int k = 0; k < T; k++) {
+            double sum = b[i * T + k];
+            TINYPROJECT_UNROLL
+            for (int j = i + 1; j < N; j++) sum -= r[i * N + j] * b[j * T + k];
+            b[i * T + k] = sum / r[i * N + i];
+        }
+    }
+    return coefficients;
+}
+
+#endif // FIXED_REGRESSION_H
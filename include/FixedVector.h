@@ -0,0 +1,135 @@
+#ifndef FIXED_VECTOR_H
+#define FIXED_VECTOR_H
+
+#include "Vector.h"
+#include "VectorExpression.h"
+#include <cmath>
+#include <stdexcept>
+
+// Fixed-size loops have compile-time trip counts; ask for them to be fully
+// unrolled even at -O2, where GCC otherwise only unrolls if code does not grow
+#if defined(__clang__)
+#define TINYPROJECT_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define TINYPROJECT_UNROLL _Pragma("GCC unroll 16")
+#else
+#define TINYPROJECT_UNROLL
+#endif
+
+/**
+ * Vector of N doubles in inline (stack) storage. Meant for the small,
+ * fixed shapes of the regression (6 features), where the allocation and
+ * bounds checks of Vector dominate the arithmetic.
+ *
+ * A FixedVector is a vector expression, so it converts to a Vector and can
+ * be mixed with Vectors in expressions; the reverse conversion is explicit
+ * and checks the size.
+ */
+template <int N>
+class FixedVector : public VectorExpression<FixedVector<N> > {
+    static_assert(N > 0, "FixedVector needs at least one element");
+
+private:
+    double mData[N];
+
+public:
+    static constexpr int kSize = N;
+
+    FixedVector() {
+        TINYPROJECT_UNROLL
+        for (int i = 0; i < N; i++) mData[i] = 0.0;
+    }
+
+    // @throws std::invalid_argument if the expression does not have N elements
+    template <typename E>
+    explicit FixedVector(const VectorExpression<E>& expression) {
+        if (expression.GetSize() != N) throw std::invalid_argument("Vector size does not match the fixed size");
+        TINYPROJECT_UNROLL
+        for (int i = 0; i < N; i++) mData[i] = expression.Element(i);
+    }
+
+    int GetSize() const { return N; }
+    double& operator()(int i) { return mData[i - 1]; }              // 1-based, unchecked
+    const double& operator()(int i) const { return mData[i - 1]; }
+    double& operator[](int i) { return mData[i]; }                  // 0-based, unchecked
+    const double& operator[](int i) const { return mData[i]; }
+    double* GetData() { return mData; }
+    const double* GetData() const { return mData; }
+    double Element(int i) const { return mData[i]; }
+
+    FixedVector& operator+=(const FixedVector& other) {
+        TINYPROJECT_UNROLL
+        for (int i = 0; i < N; i++) mData[i] += other.mData[i];
+        return *this;
+    }
+
+    FixedVector& operator-=(const FixedVector& other) {
+        TINYPROJECT_UNROLL
+        for (int i = 0; i < N; i++) mData[i] -= other.mData[i];
+        return *this;
+    }
+
+    FixedVector& operator*=(double scalar) {
+        TINYPROJECT_UNROLL
+        for (int i = 0; i < N; i++) mData[i] *= scalar;
+        return *this;
+    }
+
+    double Norm() const {
+        double sum = 0.0;
+        TINYPROJECT_UNROLL
+        for (int i = 0; i < N; i++) sum += mData[i] * mData[i];
+        return std::sqrt(sum);
+    }
+};
+
+template <int N>
+constexpr int FixedVector<N>::kSize;
+
+// Fixed vectors are leaves like Vector: held by reference inside an expression
+template <int N>
+struct VectorOperand<FixedVector<N> > {
+    typedef const FixedVector<N>& Type;
+};
+
+// Arithmetic between fixed vectors stays fixed-size and is evaluated at once
+template <int N>
+inline FixedVector<N> operator+(const FixedVector<N>& left, const FixedVector<N>& right) {
+    FixedVector<N> result(left);
+    return result += right;
+}
+
+template <int N>
+inline FixedVector<N> operator-(const FixedVector<N>& left, const FixedVector<N>& right) {
+    FixedVector<N> result(left);
+    return result -= right;
+}
+
+template <int N>
+inline FixedVector<N> operator-(const FixedVector<N>& operand) {
+    FixedVector<N> result(operand);
+    return result *= -1.0;
+}
+
+template <int N>
+inline FixedVector<N> operator*(double scalar, const FixedVector<N>& operand) {
+    FixedVector<N> result(operand);
+    return result *= scalar;
+}
+
+template <int N>
+inline FixedVector<N> operator*(const FixedVector<N>& operand, double scalar) {
+    FixedVector<N> result(operand);
+    return result *= scalar;
+}
+
+// Dot product
+template <int N>
+inline double operator*(const FixedVector<N>& left, const FixedVector<N>& right) {
+    double sum = 0.0;
+    TINYPROJECT_UNROLL
+    for (int i = 0; i < N; i++) sum += left[i] * right[i];
+    return sum;
+}
+
+#endif // FIXED_VECTOR_H
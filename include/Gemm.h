@@ -0,0 +1,33 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+/**
+ * General matrix-matrix product on raw row-major storage:
+ *
+ *     C = alpha * op(A) * op(B) + beta * C
+ *
+ * where op(X) is X or X^T depending on transA / transB. op(A) is m x k,
+ * op(B) is k x n and C is m x n. lda, ldb and ldc are the row strides of
+ * the stored (untransposed) arrays, as returned by Matrix::GetStride().
+ *
+ * Large products are cache-blocked and packed, and run an AVX2/FMA
+ * micro-kernel when the CPU supports it (detected at runtime), otherwise a
+ * portable scalar kernel. Small products use a direct loop.
+ * When beta is zero, C need not be initialised.
+ *
+ * The float overload uses the same blocking with a tile twice as wide, so
+ * each FMA does twice the work and half the bytes are moved.
+ */
+void Gemm(bool transA, bool transB, int m, int n, int k,
+          double alpha, const double* A, int lda,
+          const double* B, int ldb,
+          double beta, double* C, int ldc);
+void Gemm(bool transA, bool transB, int m, int n, int k,
+          float alpha, const float* A, int lda,
+          const float* B, int ldb,
+          float beta, float* C, int ldc);
+
+// Name of the micro-kernel selected for this CPU ("avx2-fma" or "scalar")
+const char* GemmKernelName();
+
+#endif // GEMM_H
@@ -0,0 +1,147 @@
+#ifndef HARDWARE_DATASET_H
+#define HARDWARE_DATASET_H
+
+#include "Matrix.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Numeric columns of the UCI Computer Hardware data, in file order
+enum HardwareField {
+    kMYCT,     // machine cycle time in nanoseconds
+    kMMIN,     // minimum main memory in kilobytes
+    kMMAX,     // maximum main memory in kilobytes
+    kCACH,     // cache memory in kilobytes
+    kCHMIN,    // minimum channels in units
+    kCHMAX,    // maximum channels in units
+    kPRP,      // published relative performance
+    kERP,      // estimated relative performance
+    kNumHardwareFields
+};
+
+const char* HardwareFieldName(HardwareField field);
+
+struct ParseStats {
+    std::size_t bytes;        // Input size
+    long lines;               // Non-empty lines seen
+    long rowsAccepted;
+    long rowsRejected;        // Lines that failed validation and were skipped
+    int chunks;               // Pieces parsed independently
+    double seconds;
+    bool fromCache;           // Mapped from a binary cache; bytes is then the cache size
+
+    ParseStats() : bytes(0), lines(0), rowsAccepted(0), rowsRejected(0), chunks(0), seconds(0.0), fromCache(false) {}
+    double MegabytesPerSecond() const;
+};
+
+/**
+ * Column-oriented copy of the hardware data set. Each numeric field is one
+ * contiguous int array, vendor names are interned into a dictionary and
+ * model names share one character buffer, so loading never creates a
+ * string or a struct per row.
+ *
+ * The same layout is written to a binary cache file (WriteCache) that later
+ * runs memory-map (MapCache): the accessors then read the columns straight
+ * from the mapping without decoding anything.
+ */
+class HardwareDataset {
+private:
+    int mNumRows;
+    // Storage filled by ReadCsv; empty when the data is mapped from a cache
+    std::vector<int> mColumns[kNumHardwareFields];
+    std::vector<int> mVendorIds;                   // Index into mVendorNames
+    std::vector<std::string> mVendorNames;
+    std::unordered_map<std::string, int> mVendorLookup;
+    std::vector<char> mModelNameData;              // All model names back to back
+    std::vector<std::uint64_t> mModelNameOffsets;  // mNumRows + 1 offsets into mModelNameData
+
+    // What the accessors read: the vectors above, or sections of mpMapping
+    std::shared_ptr<MappedFile> mpMapping;
+    const int* mColumnViews[kNumHardwareFields];
+    const int* mVendorIdView;
+    const char* mModelNameView;
+    const std::uint64_t* mModelOffsetView;
+
+    struct LineError;
+    struct ChunkResult;
+
+    // Points the views at the owned vectors; needed after they are filled or copied
+    void BindOwnedStorage();
+
+    // Validates one CSV line and appends it; throws std::runtime_error on a bad field
+    void AppendCsvLine(const char* begin, const char* end);
+    int InternVendor(const char* begin, const char* end);
+    // Appends the rows of every part in order, remapping their vendor ids into this dictionary
+    void AppendRows(const std::vector<const HardwareDataset*>& parts);
+    static void ParseChunk(const char* begin, const char* end, ChunkResult& result);
+    void WriteCacheFile(const std::string& cacheFilename, std::uint64_t sourceSize,
+                        std::int64_t sourceModifiedTime) const;
+
+public:
+    HardwareDataset();
+    HardwareDataset(const HardwareDataset& other);
+    HardwareDataset(HardwareDataset&& other) = default;
+    HardwareDataset& operator=(const HardwareDataset& other);
+    HardwareDataset& operator=(HardwareDataset&& other) = default;
+
+    /**
+     * Reads a comma-separated file: vendor, model, then the eight numeric
+     * fields. Lines that fail validation are reported on std::cerr with
+     * their line number and skipped. Blank lines are skipped without a
+     * report, and a numeric field must be an integer over the whole field
+     * (surrounding blanks allowed): "12abc" is rejected, where std::stoi
+     * used to read 12.
+     *
+     * The file is read in large batches, double-buffered so the next batch
+     * is read while the current one is parsed; each batch is cut at newlines
+     * into chunks that the thread pool parses independently, and the chunks
+     * are merged in file order (columns copied in parallel), so the result
+     * does not depend on the number of threads.
+     * @param stats Receives the size, row counts and parse time if not null
+     * @throws std::runtime_error if the file cannot be opened or has no valid rows
+     */
+    static HardwareDataset ReadCsv(const std::string& filename, ParseStats* stats = nullptr);
+
+    /**
+     * Writes the columns to a binary cache stamped with the size and
+     * modification time of sourceFilename.
+     * @throws std::runtime_error if either file cannot be accessed
+     */
+    void WriteCache(const std::string& cacheFilename, const std::string& sourceFilename) const;
+    /**
+     * Maps a cache written by WriteCache. The file must not be modified
+     * while any copy of the returned data set is alive.
+     * @throws std::runtime_error if the file is missing, truncated or of another version
+     */
+    static HardwareDataset MapCache(const std::string& cacheFilename);
+    // True if the cache exists, is readable by this build and matches the source's size and mtime (to the nanosecond where available)
+    static bool IsCacheCurrent(const std::string& cacheFilename, const std::string& sourceFilename);
+    /**
+     * Maps the cache if it is current, otherwise parses the CSV and
+     * rewrites the cache (a cache that cannot be written only warns).
+     * @throws std::runtime_error as ReadCsv
+     */
+    static HardwareDataset LoadCached(const std::string& csvFilename, const std::string& cacheFilename,
+                                      ParseStats* stats = nullptr);
+    bool IsMapped() const;
+
+    int GetNumRows() const;
+    const int* GetColumn(HardwareField field) const;
+    int GetValue(int row, HardwareField field) const;   // 0-based row
+
+    int GetVendorId(int row) const;
+    const std::string& GetVendorName(int row) const;
+    const std::vector<std::string>& GetVendorNames() const;
+    std::string GetModelName(int row) const;
+
+    // The six hardware features (MYCT .. CHMAX) of the given rows, one row each
+    Matrix CreateDesignMatrix(const std::vector<int>& rows) const;
+    // PRP and ERP of the given rows, one column per target
+    Matrix CreateTargetMatrix(const std::vector<int>& rows) const;
+};
+
+#endif // HARDWARE_DATASET_H
@@ -0,0 +1,53 @@
+#ifndef LU_FACTORIZATION_H
+#define LU_FACTORIZATION_H
+
+#include "Matrix.h"
+#include "Vector.h"
+#include <vector>
+
+/**
+ * LU factorization with partial pivoting, PA = LU, computed once and reused
+ * for any number of right-hand sides.
+ *
+ * L (unit lower triangular, diagonal not stored) and U are packed in place in
+ * a single n x n matrix. Row interchanges are stored LAPACK-style: during
+ * step k row k was swapped with row GetPivots()[k] (both 0-based).
+ * Large matrices are factorized in panels with the trailing update done by
+ * the blocked GEMM.
+ *
+ * Factorization never throws for singular input; IsSingular() reports
+ * whether a pivot fell below the singularity threshold and Solve() throws.
+ */
+class LUFactorization {
+private:
+    int mSize;
+    Matrix mLU;
+    std::vector<int> mPivots;
+    int mPermutationSign;
+    bool mSingular;
+
+    void Factorize();
+    void CheckSolvable(int rhsRows) const;
+
+public:
+    explicit LUFactorization(const Matrix& A);
+
+    int GetSize() const;
+    bool IsSingular() const;
+    const Matrix& GetLU() const;
+    const std::vector<int>& GetPivots() const;
+    int GetPermutationSign() const;   // +1 or -1, the determinant of P
+
+    // det(A) as the signed product of the pivots (0 if a pivot is exactly zero)
+    double Determinant() const;
+    // log|det(A)| summed pivot by pivot, so it does not overflow or underflow;
+    // -infinity for an exactly singular matrix. sign receives -1, 0 or +1.
+    double LogAbsDeterminant(int& sign) const;
+
+    // Solves Ax = b in O(n^2)
+    Vector Solve(const Vector& b) const;
+    // Solves AX = B for all columns of B with blocked triangular solves
+    Matrix Solve(const Matrix& B) const;
+};
+
+#endif // LU_FACTORIZATION_H
@@ -0,0 +1,25 @@
+#ifndef LU_KERNELS_H
+#define LU_KERNELS_H
+
+/**
+ * LU factorization with partial pivoting on raw row-major storage, the
+ * kernels behind LUFactorization. They are templated on the element type
+ * and instantiated for double and float; the float versions factorize in
+ * half the memory with twice the SIMD width (see MixedPrecisionLU).
+ *
+ * The n x n array a (row stride lda) is overwritten with L (unit lower,
+ * diagonal not stored) and U. During step k row k was swapped with row
+ * pivots[k]. Large matrices are factorized in panels with the trailing
+ * update done by the blocked GEMM of the same precision.
+ *
+ * permutationSign receives +1 or -1. singular is set if a pivot fell below
+ * the singularity threshold; the factorization still completes.
+ */
+template <typename T>
+void FactorizeLU(int n, T* a, int lda, int* pivots, int& permutationSign, bool& singular);
+
+// Overwrites x = b with the solution of A x = b from the factors, in O(n^2)
+template <typename T>
+void SolveLU(int n, const T* lu, int lda, const int* pivots, T* x);
+
+#endif // LU_KERNELS_H
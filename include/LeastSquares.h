@@ -0,0 +1,32 @@
+#ifndef LEAST_SQUARES_H
+#define LEAST_SQUARES_H
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "QRFactorization.h"
+
+/**
+ * Linear least squares min ||X beta - y|| solved from a Householder QR of X.
+ *
+ * Unlike the normal equations X^T X beta = X^T y, this does not square the
+ * condition number of X. X is factorized once in O(mn^2) and every target
+ * (one column of Y each) reuses the factors; no pseudo-inverse is formed.
+ */
+class LeastSquares {
+private:
+    QRFactorization mQR;
+
+public:
+    // @throws std::invalid_argument if X has fewer rows than columns
+    explicit LeastSquares(const Matrix& X);
+
+    // Coefficients for a single target
+    Vector Solve(const Vector& y) const;
+    // Coefficients for several targets, one column of the result per column of Y
+    Matrix Solve(const Matrix& Y) const;
+
+    int GetRank() const;
+    const QRFactorization& GetFactorization() const;
+};
+
+#endif // LEAST_SQUARES_H
@@ -0,0 +1,70 @@
+#ifndef LINEAR_OPERATOR_H
+#define LINEAR_OPERATOR_H
+
+#include "Vector.h"
+#include <functional>
+
+/**
+ * Anything that can compute y = A x and y = A^T x. Iterative solvers only
+ * need these products, so they take a LinearOperator rather than a dense
+ * Matrix. Matrix implements it directly; FunctionOperator wraps callbacks and
+ * NormalOperator applies X^T X without forming it.
+ */
+class LinearOperator {
+public:
+    virtual ~LinearOperator();
+
+    virtual int GetNumRows() const = 0;
+    virtual int GetNumCols() const = 0;
+
+    // y = A x; y already has GetNumRows() entries and must not alias x
+    virtual void Apply(const Vector& x, Vector& y) const = 0;
+    // y = A^T x; y already has GetNumCols() entries and must not alias x
+    virtual void ApplyTranspose(const Vector& x, Vector& y) const = 0;
+};
+
+/**
+ * Operator defined by user callbacks. The transpose callback may be empty
+ * for a symmetric operator, in which case Apply is used for both.
+ */
+class FunctionOperator : public LinearOperator {
+public:
+    typedef std::function<void(const Vector&, Vector&)> Callback;
+
+private:
+    int mNumRows;
+    int mNumCols;
+    Callback mApply;
+    Callback mApplyTranspose;
+
+public:
+    FunctionOperator(int numRows, int numCols, const Callback& apply,
+                     const Callback& applyTranspose = Callback());
+
+    virtual int GetNumRows() const override;
+    virtual int GetNumCols() const override;
+    virtual void Apply(const Vector& x, Vector& y) const override;
+    virtual void ApplyTranspose(const Vector& x, Vector& y) const override;
+};
+
+/**
+ * The n x n operator X^T X for an m x n operator X, applied as X^T (X p).
+ * Solving X^T X beta = X^T y with it never forms the Gram matrix.
+ * Holds a reference to X and one m-vector of scratch space, so one
+ * instance must not be applied from several threads at once.
+ */
+class NormalOperator : public LinearOperator {
+private:
+    const LinearOperator& mX;
+    mutable Vector mScratch;
+
+public:
+    explicit NormalOperator(const LinearOperator& X);
+
+    virtual int GetNumRows() const override;
+    virtual int GetNumCols() const override;
+    virtual void Apply(const Vector& x, Vector& y) const override;
+    virtual void ApplyTranspose(const Vector& x, Vector& y) const override;
+};
+
+#endif // LINEAR_OPERATOR_H
@@ -3,6 +3,14 @@
 
 #include "Matrix.h"
 #include "Vector.h"
+#include "LUFactorization.h"
+#include "MixedPrecisionLU.h"
+#include <mutex>
+
+enum class SolverPrecision {
+    Double,    // LU factorization in double (default)
+    Mixed      // Float LU refined to double accuracy, see MixedPrecisionLU
+};
 
 class LinearSystem {
 protected:
@@ -10,6 +18,13 @@ protected:
     Matrix* mpA;
     Vector* mpb;
 
+private:
+    mutable LUFactorization* mpLU;    // Built on first solve, then reused
+    mutable std::once_flag mLUOnce;
+    SolverPrecision mPrecision;
+    mutable MixedPrecisionLU* mpMixed;
+    mutable std::once_flag mMixedOnce;
+
 public:
     LinearSystem(const Matrix& A, const Vector& b);
     virtual ~LinearSystem();
@@ -18,6 +33,18 @@ public:
     LinearSystem& operator=(const LinearSystem& other) = delete;
     
     virtual Vector Solve() const;
+
+    // Solves against the cached LU factors of A with a different right-hand side
+    virtual Vector Solve(const Vector& b) const;
+    virtual Matrix Solve(const Matrix& B) const;
+
+    const LUFactorization& GetFactorization() const;
+    const MixedPrecisionLU& GetMixedFactorization() const;
+
+    // Selects the factorization behind Solve; derived systems with their own
+    // solver (PosSymLinSystem) ignore it
+    void SetPrecision(SolverPrecision precision);
+    SolverPrecision GetPrecision() const;
 };
 
-#endif // LINEAR_SYSTEM_H
\ No newline at end of file
+#endif // LINEAR_SYSTEM_H
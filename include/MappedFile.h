@@ -0,0 +1,29 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Read-only memory mapping of a whole file (mmap on POSIX, MapViewOfFile on
+ * Windows). The contents are paged in on first touch and the mapping stays
+ * valid until the object is destroyed, independent of the file handle.
+ */
+class MappedFile {
+private:
+    const char* mData;
+    std::size_t mSize;
+
+public:
+    // @throws std::runtime_error if the file cannot be opened, is empty or cannot be mapped
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+
+    const char* GetData() const;   // Page aligned
+    std::size_t GetSize() const;
+};
+
+#endif // MAPPED_FILE_H
@@ -2,50 +2,89 @@
 #define MATRIX_H
 
 #include "Vector.h"
+#include "LinearOperator.h"
+#include "MatrixExpression.h"
+#include "ThreadPool.h"
+#include <cstddef>
+#include <utility>
 #include <vector>
 
-class Matrix {
+class Matrix final : public LinearOperator, public MatrixExpression<Matrix> {
 private:
     int mNumRows;
     int mNumCols;
-    double** mData;
+    int mStride;     // Leading dimension: elements between consecutive rows
+    double* mData;   // Single 64-byte-aligned row-major buffer
 
     void AllocateMemory();
     void DeallocateMemory();
     void CopyData(const Matrix& other);
+    static int RowGrain(int numCols);   // Rows per parallel task for elementwise work
+    template <typename E>
+    void Evaluate(const E& expression);
 
 public:
     // Constructors and destructor
     Matrix();
     Matrix(int numRows, int numCols);
     Matrix(const Matrix& other);
+    Matrix(Matrix&& other) noexcept;
+    // Evaluates an elementwise expression such as A + 2.0 * B in one pass
+    template <typename E>
+    Matrix(const MatrixExpression<E>& expression);
     ~Matrix();
 
     // Accessors
-    int GetNumRows() const;
-    int GetNumCols() const;
+    int GetNumRows() const override;
+    int GetNumCols() const override;
     double& operator()(int i, int j);              // 1-based indexing
     const double& operator()(int i, int j) const; // 1-based indexing const version
 
-    // Assignment operator
+    // Raw storage access for kernels: element (i, j) (0-based) lives at
+    // GetData()[i * GetStride() + j]. Rows are padded to a 64-byte boundary.
+    double* GetData();
+    const double* GetData() const;
+    int GetStride() const;
+    // 0-based, unchecked (expression leaf)
+    double Element(int i, int j) const { return mData[static_cast<std::size_t>(i) * mStride + j]; }
+
+    // Assignment operators
     Matrix& operator=(const Matrix& other);
+    Matrix& operator=(Matrix&& other) noexcept;
+    template <typename E>
+    Matrix& operator=(const MatrixExpression<E>& expression);
+
+    // In-place operators (no allocation)
+    Matrix& operator+=(const Matrix& other);
+    Matrix& operator-=(const Matrix& other);
+    Matrix& operator*=(double scalar);
+    Matrix& Axpy(double alpha, const Matrix& x); // *this += alpha * x
 
-    // Unary operators
+    // Unary plus copies; negation, +, - and scaling are the lazy expressions
+    // of MatrixExpression.h
     Matrix operator+() const;
-    Matrix operator-() const;
 
-    // Binary operators
-    Matrix operator+(const Matrix& other) const;
-    Matrix operator-(const Matrix& other) const;
+    // Products (evaluated immediately)
     Matrix operator*(const Matrix& other) const;
     Vector operator*(const Vector& vec) const;
-    Matrix operator*(double scalar) const;
+
+    // result = (*this) * vec, writing into an existing vector of matching size
+    void Multiply(const Vector& vec, Vector& result) const;
+    // result = (*this)^T * vec without forming the transpose
+    void MultiplyTranspose(const Vector& vec, Vector& result) const;
+
+    // LinearOperator interface (same as Multiply / MultiplyTranspose)
+    void Apply(const Vector& x, Vector& y) const override;
+    void ApplyTranspose(const Vector& x, Vector& y) const override;
 
     // Matrix operations
     Matrix Transpose() const;
     double Determinant() const;
+    double LogDeterminant(int& sign) const; // log|det|, sign set to -1, 0 or +1
     Matrix Inverse() const;
     Matrix PseudoInverse() const;
+    // Via the SVD, dropping singular values <= tolerance (< 0: default cutoff)
+    Matrix PseudoInverse(double tolerance) const;
     Matrix SubMatrix(int excludeRow, int excludeCol) const;
 
     // Utility functions
@@ -54,7 +93,56 @@ public:
     bool IsSymmetric() const;
 };
 
-// Non-member function for scalar multiplication
-Matrix operator*(double scalar, const Matrix& mat);
+// Exact match for A * s, which would otherwise tie with A * Vector(int(s))
+inline MatrixScaledExpression<Matrix> operator*(const Matrix& mat, double scalar) {
+    return MatrixScaledExpression<Matrix>(scalar, mat);
+}
+
+template <typename E>
+void Matrix::Evaluate(const E& expression) {
+    const int numCols = mNumCols;
+    ThreadPool::Global().ParallelFor(0, mNumRows, RowGrain(numCols), [&](int first, int last) {
+        for (int i = first; i < last; i++) {
+            double* row = mData + static_cast<std::size_t>(i) * mStride;
+            int j = 0;
+            for (; j + kExpressionBlock <= numCols; j += kExpressionBlock) {
+                const double x0 = expression.Element(i, j);
+                const double x1 = expression.Element(i, j + 1);
+                const double x2 = expression.Element(i, j + 2);
+                const double x3 = expression.Element(i, j + 3);
+                row[j] = x0;
+                row[j + 1] = x1;
+                row[j + 2] = x2;
+                row[j + 3] = x3;
+            }
+            for (; j < numCols; j++) row[j] = expression.Element(i, j);
+        }
+    });
+}
+
+template <typename E>
+Matrix::Matrix(const MatrixExpression<E>& expression)
+    : mNumRows(expression.GetNumRows()), mNumCols(expression.GetNumCols()), mStride(0), mData(nullptr) {
+    AllocateMemory();
+    Evaluate(expression.Derived());
+}
+
+// In place when the shape is unchanged (safe even if this matrix appears in
+// the expression), otherwise built aside so the old storage stays readable
+template <typename E>
+Matrix& Matrix::operator=(const MatrixExpression<E>& expression) {
+    if (expression.GetNumRows() == mNumRows && expression.GetNumCols() == mNumCols) {
+        Evaluate(expression.Derived());
+    } else {
+        Matrix result(expression);
+        *this = std::move(result);
+    }
+    return *this;
+}
+
+template <typename E>
+void MatrixExpression<E>::Print() const {
+    Matrix(*this).Print();
+}
 
 #endif // MATRIX_H
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef MATRIX_EXPRESSION_H
+#define MATRIX_EXPRESSION_H
+
+#include "VectorExpression.h"
+#include <stdexcept>
+
+class Matrix;
+
+/**
+ * Base of the lazy elementwise matrix expressions (CRTP), the counterpart
+ * of VectorExpression. A tree such as A + 2.0 * B - C is evaluated row by
+ * row in one parallel pass when assigned to a Matrix. E provides
+ * GetNumRows(), GetNumCols() and Element(i, j) (0-based). Products are not
+ * elementwise and still evaluate eagerly through the GEMM.
+ */
+template <typename E>
+class MatrixExpression {
+public:
+    const E& Derived() const { return static_cast<const E&>(*this); }
+    int GetNumRows() const { return Derived().GetNumRows(); }
+    int GetNumCols() const { return Derived().GetNumCols(); }
+    double Element(int i, int j) const { return Derived().Element(i, j); }
+
+    void Print() const;   // Evaluates into a Matrix first (defined in Matrix.h)
+};
+
+template <typename E>
+struct MatrixOperand {
+    typedef const E Type;
+};
+
+template <>
+struct MatrixOperand<Matrix> {
+    typedef const Matrix& Type;
+};
+
+template <typename L, typename R, typename Op>
+class MatrixBinaryExpression : public MatrixExpression<MatrixBinaryExpression<L, R, Op> > {
+private:
+    typename MatrixOperand<L>::Type mLeft;
+    typename MatrixOperand<R>::Type mRight;
+
+public:
+    MatrixBinaryExpression(const L& left, const R& right) : mLeft(left), mRight(right) {
+        if (left.GetNumRows() != right.GetNumRows() || left.GetNumCols() != right.GetNumCols())
+            throw std::invalid_argument("Matrix dimensions must match");
+    }
+    int GetNumRows() const { return mLeft.GetNumRows(); }
+    int GetNumCols() const { return mLeft.GetNumCols(); }
+    double Element(int i, int j) const { return Op::Apply(mLeft.Element(i, j), mRight.Element(i, j)); }
+};
+
+template <typename E>
+class MatrixScaledExpression : public MatrixExpression<MatrixScaledExpression<E> > {
+private:
+    double mScalar;
+    typename MatrixOperand<E>::Type mOperand;
+
+public:
+    MatrixScaledExpression(double scalar, const E& operand) : mScalar(scalar), mOperand(operand) {}
+    int GetNumRows() const { return mOperand.GetNumRows(); }
+    int GetNumCols() const { return mOperand.GetNumCols(); }
+    double Element(int i, int j) const { return mScalar * mOperand.Element(i, j); }
+};
+
+template <typename L, typename R>
+inline MatrixBinaryExpression<L, R, ExpressionAdd>
+operator+(const MatrixExpression<L>& left, const MatrixExpression<R>& right) {
+    return MatrixBinaryExpression<L, R, ExpressionAdd>(left.Derived(), right.Derived());
+}
+
+template <typename L, typename R>
+inline MatrixBinaryExpression<L, R, ExpressionSubtract>
+operator-(const MatrixExpression<L>& left, const MatrixExpression<R>& right) {
+    return MatrixBinaryExpression<L, R, ExpressionSubtract>(left.Derived(), right.Derived());
+}
+
+template <typename E>
+inline MatrixScaledExpression<E> operator-(const MatrixExpression<E>& operand) {
+    return MatrixScaledExpression<E>(-1.0, operand.Derived());
+}
+
+template <typename E>
+inline MatrixScaledExpression<E> operator*(double scalar, const MatrixExpression<E>& operand) {
+    return MatrixScaledExpression<E>(scalar, operand.Derived());
+}
+
+template <typename E>
+inline MatrixScaledExpression<E> operator*(const MatrixExpression<E>& operand, double scalar) {
+    return MatrixScaledExpression<E>(scalar, operand.Derived());
+}
+
+#endif // MATRIX_EXPRESSION_H
@@ -0,0 +1,83 @@
+#ifndef MIXED_PRECISION_LU_H
+#define MIXED_PRECISION_LU_H
+
+#include "LUFactorization.h"
+#include "Matrix.h"
+#include "Vector.h"
+#include <mutex>
+#include <vector>
+
+struct RefinementOptions {
+    int maxIterations;   // Corrections tried before falling back to a double factorization
+    double tolerance;    // Stop once ||b - Ax|| <= tolerance * ||A|| * ||x|| (infinity norms);
+                         // 0 selects sqrt(n) * machine epsilon of double
+
+    RefinementOptions() : maxIterations(30), tolerance(0.0) {}
+};
+
+struct RefinementResult {
+    int iterations;        // Corrections applied to the float solution
+    bool converged;        // The tolerance was met from the float factors
+    bool usedFallback;     // Solved by a double LU instead (float factors unusable or refinement stalled)
+    double backwardError;  // ||b - Ax|| / (||A|| ||x|| + ||b||) of the returned x
+
+    RefinementResult() : iterations(0), converged(false), usedFallback(false), backwardError(0.0) {}
+};
+
+/**
+ * Mixed-precision LU solver: A is factorized in float, which moves half the
+ * bytes and fits twice as many lanes per SIMD register as double, and the
+ * solution is brought to double accuracy by iterative refinement,
+ *
+ *     r = b - A x      (double)
+ *     A d = r          (float factors)
+ *     x = x + d
+ *
+ * until the normwise residual meets the tolerance. This converges when A is
+ * not too ill-conditioned for float (cond(A) well below 1e7). Otherwise, or
+ * if A does not fit the float range, the solve falls back to an ordinary
+ * double LUFactorization, computed on first need, so the answer is never
+ * worse than LinearSystem's.
+ *
+ * The residuals are computed from the caller's A, which is not copied: A
+ * must outlive the solver and must not change while it is in use (as
+ * LinearSystem guarantees for its own matrix). Only the float factors, and
+ * the double factors if the fallback is needed, are stored. Solves are safe
+ * to run from several threads.
+ */
+class MixedPrecisionLU {
+private:
+    int mSize;
+    const Matrix* mpA;            // Not owned; see above
+    double mNormA;                // ||A|| (infinity norm)
+    float* mpLowLU;               // Float factors, row stride mLowStride
+    int mLowStride;
+    std::vector<int> mLowPivots;
+    bool mLowUsable;              // Float factors exist and no pivot vanished
+    RefinementOptions mOptions;
+
+    mutable LUFactorization* mpFallback;
+    mutable std::once_flag mFallbackOnce;
+
+    const LUFactorization& GetFallback() const;
+
+public:
+    // A must outlive the solver; @throws std::invalid_argument if A is not square
+    explicit MixedPrecisionLU(const Matrix& A, const RefinementOptions& options = RefinementOptions());
+    ~MixedPrecisionLU();
+
+    MixedPrecisionLU(const MixedPrecisionLU& other) = delete;
+    MixedPrecisionLU& operator=(const MixedPrecisionLU& other) = delete;
+
+    int GetSize() const;
+    // False if A overflowed float or a float pivot vanished; every solve then uses the fallback
+    bool IsLowPrecisionUsable() const;
+
+    // @param result Receives the iteration count, convergence and backward error if not null
+    // @throws std::runtime_error if A is singular
+    Vector Solve(const Vector& b, RefinementResult* result = nullptr) const;
+    // Refines every column of B independently
+    Matrix Solve(const Matrix& B) const;
+};
+
+#endif // MIXED_PRECISION_LU_H
@@ -0,0 +1,77 @@
+#ifndef ONLINE_REGRESSION_H
+#define ONLINE_REGRESSION_H
+
+#include "Matrix.h"
+#include "RegressionAccumulator.h"
+#include "Vector.h"
+#include <vector>
+
+/**
+ * Recursive least squares that keeps the triangular factor of the data
+ * instead of refitting.
+ *
+ * The state is an upper triangular R with R^T R = sum of w x x^T, the
+ * rotated targets d with R^T d = sum of w x y^T, and the residual sum of
+ * squares. Adding an observation applies n Givens rotations to [R | d];
+ * removing one is the LINPACK Cholesky downdate. Both cost O(n^2 + nt) and
+ * never form X^T X, so the factor keeps the accuracy of a QR fit.
+ *
+ * With a forgetting factor lambda < 1 every addition first scales the
+ * existing state by lambda, so an observation added k steps ago carries
+ * weight lambda^k. Removing an old observation must pass that decayed
+ * weight.
+ */
+class OnlineRegression {
+private:
+    int mNumFeatures;
+    int mNumTargets;
+    double mForgetting;
+    double mTotalWeight;          // Sum of the current observation weights
+    Matrix mR;                    // Upper triangular factor, n x n
+    Matrix mRotatedTargets;       // d, n x t
+    Vector mResidualSquares;      // Residual sum of squares per target
+    std::vector<double> mScratch; // Work space of the updates
+
+public:
+    /**
+     * Starts with no observations. A positive ridge starts R at
+     * sqrt(ridge) I, so coefficients exist before n observations arrive.
+     * The ridge is part of the state like an observation: with forgetting
+     * 1 it shrinks the coefficients towards zero by that amount for good,
+     * but with lambda < 1 it is scaled with everything else, so after k
+     * additions the penalty left is lambda^k * ridge and the model is no
+     * longer regularized once the window has moved on (the usual
+     * recursive least squares start-up).
+     * @throws std::invalid_argument unless the counts are positive, 0 < forgetting <= 1 and ridge >= 0
+     */
+    OnlineRegression(int numFeatures, int numTargets = 1, double forgetting = 1.0, double ridge = 0.0);
+    // Starts from the triangular factor of an accumulated batch fit
+    // @throws std::invalid_argument unless 0 < forgetting <= 1
+    explicit OnlineRegression(const RegressionAccumulator& initial, double forgetting = 1.0);
+
+    // Adds one observation (n features, t targets) with the given weight
+    // @throws std::invalid_argument if weight is negative
+    void AddObservation(const double* x, const double* y, double weight = 1.0);
+    void AddObservation(const Vector& x, const Vector& y, double weight = 1.0);
+
+    /**
+     * Removes an observation that was added before, with its current
+     * weight. The state is unchanged if the removal fails.
+     * @throws std::runtime_error if the remaining data would not be positive definite
+     */
+    void RemoveObservation(const double* x, const double* y, double weight = 1.0);
+    void RemoveObservation(const Vector& x, const Vector& y, double weight = 1.0);
+
+    int GetNumFeatures() const;
+    int GetNumTargets() const;
+    double GetForgetting() const;
+    double GetTotalWeight() const;
+    const Matrix& GetR() const;
+
+    // Back substitution R b = d, O(n^2 t); one column per target
+    // @throws std::runtime_error if R is singular (too few observations)
+    Matrix GetCoefficients() const;
+    const Vector& GetResidualSumOfSquares() const;
+};
+
+#endif // ONLINE_REGRESSION_H
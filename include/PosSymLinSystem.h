@@ -2,17 +2,43 @@
 #define POS_SYM_LIN_SYSTEM_H
 
 #include "LinearSystem.h"
+#include "CholeskyFactorization.h"
+#include "ConjugateGradient.h"
+#include "SparseMatrix.h"
 
 class PosSymLinSystem : public LinearSystem {
 private:
-    bool isPositiveDefinite(const Matrix& A) const;
-    bool isAllEigenvaluesPositive(const Matrix& A) const;
+    CholeskyFactorization* mpCholesky;   // Computed once by the constructor
 
 public:
     PosSymLinSystem(const Matrix& A, const Vector& b);
     virtual ~PosSymLinSystem();
     
     virtual Vector Solve() const override;
+    virtual Vector Solve(const Vector& b) const override;
+    virtual Matrix Solve(const Matrix& B) const override;
+
+    // Conjugate gradient on A, without using the Cholesky factor
+    Vector SolveConjugateGradient() const;
+
+    // Preconditioned conjugate gradient with explicit convergence controls
+    ConjugateGradientResult SolveConjugateGradient(const ConjugateGradientOptions& options,
+                                                   PreconditionerType preconditioner = PreconditionerType::None,
+                                                   double ssorOmega = 1.0) const;
+
+    // Preconditioned conjugate gradient on a sparse A; nothing is densified,
+    // so time and memory scale with the number of nonzeros
+    static ConjugateGradientResult SolveConjugateGradient(const SparseMatrix& A, const Vector& b,
+                                                          const ConjugateGradientOptions& options = ConjugateGradientOptions(),
+                                                          PreconditionerType preconditioner = PreconditionerType::None,
+                                                          double ssorOmega = 1.0);
+
+    const CholeskyFactorization& GetCholesky() const;
+
+    // lambda_max / lambda_min of A, estimated by Lanczos
+    double EstimateConditionNumber() const;
+    // Preconditioner suggested for SolveConjugateGradient on this system
+    PreconditionerType RecommendPreconditioner() const;
 };
 
-#endif // POS_SYM_LIN_SYSTEM_H
\ No newline at end of file
+#endif // POS_SYM_LIN_SYSTEM_H
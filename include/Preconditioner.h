@@ -0,0 +1,122 @@
+#ifndef PRECONDITIONER_H
+#define PRECONDITIONER_H
+
+#include "Matrix.h"
+#include "SparseMatrix.h"
+#include "Vector.h"
+#include <memory>
+
+/**
+ * Approximate inverse M^-1 of a symmetric positive definite matrix, applied
+ * once per iteration of the preconditioned conjugate gradient method.
+ */
+class Preconditioner {
+public:
+    virtual ~Preconditioner();
+
+    // z = M^-1 r; z already has the size of r and must not alias it
+    virtual void Apply(const Vector& r, Vector& z) const = 0;
+};
+
+enum class PreconditionerType {
+    None,
+    Jacobi,                // M = diag(A)
+    SSOR,                  // Symmetric successive over-relaxation (omega = 1 is symmetric Gauss-Seidel)
+    IncompleteCholesky     // IC(0): Cholesky restricted to the nonzero pattern of A
+};
+
+class JacobiPreconditioner : public Preconditioner {
+private:
+    Vector mInverseDiagonal;
+
+public:
+    explicit JacobiPreconditioner(const Matrix& A);
+    explicit JacobiPreconditioner(const SparseMatrix& A);
+    // From a precomputed diagonal, e.g. the squared column norms of X for a
+    // matrix-free X^T X
+    explicit JacobiPreconditioner(const Vector& diagonal);
+    virtual void Apply(const Vector& r, Vector& z) const override;
+};
+
+/**
+ * M = (D/w + L) (D/w)^-1 (D/w + L^T) * w / (2 - w) for A = L + D + L^T.
+ * Applying it costs one forward and one backward sweep over A.
+ */
+class SSORPreconditioner : public Preconditioner {
+private:
+    Matrix mA;
+    double mOmega;
+
+public:
+    // @throws std::invalid_argument unless 0 < omega < 2
+    SSORPreconditioner(const Matrix& A, double omega = 1.0);
+    virtual void Apply(const Vector& r, Vector& z) const override;
+};
+
+/**
+ * Zero fill-in incomplete Cholesky, A ~ L L^T with L kept on the sparsity
+ * pattern of A. If a pivot breaks down, the factorization is retried on
+ * A + shift * diag(A) with a growing shift.
+ */
+class IncompleteCholeskyPreconditioner : public Preconditioner {
+private:
+    Matrix mL;
+    double mShift;
+
+    bool TryFactorize(const Matrix& A, double shift);
+
+public:
+    explicit IncompleteCholeskyPreconditioner(const Matrix& A);
+    virtual void Apply(const Vector& r, Vector& z) const override;
+
+    double GetShift() const;   // Diagonal shift that was needed (0 if none)
+};
+
+// SSORPreconditioner for a CSR matrix; each sweep costs O(nonzeros)
+class SparseSSORPreconditioner : public Preconditioner {
+private:
+    SparseMatrix mA;
+    Vector mDiagonal;
+    double mOmega;
+
+public:
+    // @throws std::invalid_argument unless 0 < omega < 2
+    SparseSSORPreconditioner(const SparseMatrix& A, double omega = 1.0);
+    virtual void Apply(const Vector& r, Vector& z) const override;
+};
+
+// IncompleteCholeskyPreconditioner for a CSR matrix; L is stored in CSR
+// with the diagonal as the last entry of each row
+class SparseIncompleteCholeskyPreconditioner : public Preconditioner {
+private:
+    std::vector<int> mRowPointers;
+    std::vector<int> mColumnIndices;
+    std::vector<double> mValues;
+    double mShift;
+
+    bool TryFactorize(const SparseMatrix& A, double shift);
+
+public:
+    explicit SparseIncompleteCholeskyPreconditioner(const SparseMatrix& A);
+    virtual void Apply(const Vector& r, Vector& z) const override;
+
+    double GetShift() const;   // Diagonal shift that was needed (0 if none)
+};
+
+// Builds the preconditioner of the given type for A (nullptr for None)
+std::unique_ptr<Preconditioner> MakePreconditioner(PreconditionerType type, const Matrix& A,
+                                                   double ssorOmega = 1.0);
+std::unique_ptr<Preconditioner> MakePreconditioner(PreconditionerType type, const SparseMatrix& A,
+                                                   double ssorOmega = 1.0);
+
+/**
+ * Suggests a preconditioner for CG on the SPD matrix A from Lanczos estimates
+ * of the condition numbers of A and of its Jacobi-scaled form
+ * D^-1/2 A D^-1/2: None when A is already well conditioned, Jacobi when
+ * diagonal scaling alone fixes it, otherwise IC(0) for sparse patterns and
+ * SSOR for dense ones (where IC(0) would be a full Cholesky).
+ */
+PreconditionerType RecommendPreconditioner(const Matrix& A);
+PreconditionerType RecommendPreconditioner(const SparseMatrix& A);
+
+#endif // PRECONDITIONER_H
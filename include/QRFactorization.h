@@ -0,0 +1,62 @@
+#ifndef QR_FACTORIZATION_H
+#define QR_FACTORIZATION_H
+
+#include "Matrix.h"
+#include "Vector.h"
+#include <vector>
+
+/**
+ * Householder QR factorization A = Q R of an m x n matrix with m >= n.
+ *
+ * R is stored in the upper triangle and the Householder vectors below it
+ * (LAPACK layout, unit diagonal implied). Columns are factorized in panels;
+ * each panel's reflectors are aggregated into the compact WY form
+ * I - V T V^T so the trailing update and every application of Q are done
+ * by the blocked GEMM. The panels' V are expanded once, at factorization
+ * time, so applying Q costs only the GEMMs. Q itself is never formed unless
+ * GetQ() is called.
+ */
+class QRFactorization {
+private:
+    int mNumRows;
+    int mNumCols;
+    Matrix mQR;                  // R on and above the diagonal, reflectors below
+    std::vector<double> mTau;    // Householder scalars, one per column
+    std::vector<Matrix> mV;      // Explicit reflectors of each panel (unit diagonal, zeros above)
+    std::vector<Matrix> mT;      // Upper triangular T of each panel's WY form
+
+    void Factorize();
+    Matrix PanelReflectors(int j0, int j1) const;
+    void ApplyPanel(int panel, bool transpose, double* c, int ldc, int numCols) const;
+    void CheckSolvable(int rhsRows) const;
+    Matrix BackSubstitute(const Matrix& QtB) const;
+
+public:
+    // @throws std::invalid_argument if A has fewer rows than columns
+    explicit QRFactorization(const Matrix& A);
+
+    int GetNumRows() const;
+    int GetNumCols() const;
+
+    Matrix GetR() const;   // n x n upper triangular factor
+    Matrix GetQ() const;   // m x n factor with orthonormal columns
+
+    // Numerical rank from the diagonal of R, relative to its largest entry
+    int GetRank() const;
+    bool IsFullRank() const;
+
+    // B <- Q^T B and B <- Q B for a B with m rows
+    void ApplyQTranspose(Matrix& B) const;
+    void ApplyQ(Matrix& B) const;
+    void ApplyQTranspose(Vector& b) const;
+
+    // Least-squares solution of min ||A x - b||, O(mn)
+    Vector Solve(const Vector& b) const;
+    // Least-squares solution for every column of B with one factorization
+    Matrix Solve(const Matrix& B) const;
+
+    // R^-1 Q^T (n x m), the Moore-Penrose pseudo-inverse of a full-rank A
+    Matrix PseudoInverse() const;
+};
+
+#endif // QR_FACTORIZATION_H
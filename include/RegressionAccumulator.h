@@ -0,0 +1,87 @@
+#ifndef REGRESSION_ACCUMULATOR_H
+#define REGRESSION_ACCUMULATOR_H
+
+#include "Matrix.h"
+#include "Vector.h"
+
+/**
+ * Streaming least squares for linear regression.
+ *
+ * Rows of X (m x n) and Y (m x t) are consumed in batches of any size and
+ * folded into the triangular factor of the data: an upper triangular R
+ * with R^T R = X^T X, the rotated targets d with R^T d = X^T Y, and the
+ * residual sum of squares of the least-squares fit per target. Memory stays
+ * O(n^2 + nt) however many rows pass through. Each block of rows is
+ * absorbed into [R | d] by Householder reflections, so X^T X is never
+ * formed and the fit keeps the accuracy of a QR solve. Accumulators built
+ * on different threads or file shards are combined with Merge, the QR of
+ * the stacked factors. Coefficients and residuals are computed from the
+ * factor alone; X is never needed again.
+ *
+ * Batches are split into a fixed number of row shards that the thread pool
+ * factors independently; shard boundaries depend only on the batch size and
+ * the shards are merged in order, so the result is the same for any number
+ * of threads.
+ */
+class RegressionAccumulator {
+private:
+    int mNumFeatures;
+    int mNumTargets;
+    long long mNumRows;
+    Matrix mR;                  // Upper triangular factor, n x n, non-negative diagonal
+    Matrix mRotatedTargets;     // d, n x t
+    Vector mResidualSquares;    // Residual sum of squares of the least-squares fit per target
+
+public:
+    // @throws std::invalid_argument unless both counts are positive
+    explicit RegressionAccumulator(int numFeatures, int numTargets = 1);
+
+    /**
+     * Adds a batch stored row-major: row i of X at X + i * ldx, of Y at Y + i * ldy
+     * @throws std::invalid_argument if numRows is negative
+     */
+    void AddRows(int numRows, const double* X, int ldx, const double* Y, int ldy);
+    // @throws std::invalid_argument if the shapes do not match the accumulator
+    void AddRows(const Matrix& X, const Matrix& Y);
+    void AddRows(const Matrix& X, const Vector& y);   // Single-target accumulators only
+
+    // Absorbs the factor of other, as if its rows had been added here
+    // @throws std::invalid_argument if the dimensions differ
+    void Merge(const RegressionAccumulator& other);
+    /**
+     * Removes the rows of other, which must have been added here before
+     * (downdating, e.g. a global accumulator minus one fold). The state is
+     * unchanged if the removal fails.
+     * @throws std::invalid_argument if the dimensions differ or other has more rows
+     * @throws std::runtime_error if the remaining rows would be rank deficient, or a
+     *         residual would go negative beyond rounding (other's rows were not all added)
+     */
+    void Subtract(const RegressionAccumulator& other);
+
+    int GetNumFeatures() const;
+    int GetNumTargets() const;
+    long long GetNumRows() const;
+    const Matrix& GetR() const;
+    const Matrix& GetRotatedTargets() const;
+    const Vector& GetResidualSquares() const;     // At the least-squares coefficients
+    // The sums, formed from the factor on request
+    Matrix GetGram() const;                       // X^T X = R^T R
+    Matrix GetCrossProducts() const;              // X^T Y = R^T d
+    Vector GetTargetSquares() const;              // y^T y = ||d||^2 + residual
+
+    // False if a column of X is (numerically) a combination of the earlier ones
+    bool IsFullRank() const;
+    /**
+     * Least-squares coefficients, one column per target, by back
+     * substitution R b = d
+     * @throws std::runtime_error if X is rank deficient
+     */
+    Matrix Solve() const;
+
+    // ||y - X b||^2 per target, from ||d - R b||^2 + residual
+    Vector ResidualSumOfSquares(const Matrix& coefficients) const;
+    // sqrt(RSS / rows) per target; @throws std::runtime_error if no rows were added
+    Vector RootMeanSquaredError(const Matrix& coefficients) const;
+};
+
+#endif // REGRESSION_ACCUMULATOR_H
@@ -0,0 +1,96 @@
+#ifndef REGULARIZED_REGRESSION_H
+#define REGULARIZED_REGRESSION_H
+
+#include "Matrix.h"
+#include "RegressionAccumulator.h"
+#include "SymmetricEigenSolver.h"
+#include "Vector.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct CoordinateDescentOptions {
+    int maxSweeps;        // Passes over the working set per lambda
+    double tolerance;     // Largest coefficient change, in standardized units
+    bool screening;       // Sequential strong rule with a KKT check
+
+    CoordinateDescentOptions() : maxSweeps(1000), tolerance(1e-8), screening(true) {}
+};
+
+struct RegularizationPath {
+    Vector lambdas;
+    Matrix coefficients;           // n x L, column l in the original feature units
+    Vector trainRMSE;              // One per lambda
+    std::vector<int> activeCounts; // Non-zero coefficients per lambda
+    std::vector<int> sweeps;       // Coordinate descent passes per lambda (0 for ridge)
+    bool converged;
+};
+
+/**
+ * Penalized least squares over a grid of penalties, from accumulated sums.
+ *
+ * The objective for one target is
+ *
+ *     1/(2m) ||y - X b||^2 + lambda (alpha ||b||_1 + (1 - alpha)/2 ||b||^2)
+ *
+ * with the features scaled to unit root mean square (no centering, as the
+ * models have no intercept); coefficients are reported in the original
+ * units. Everything works on the n x n Gram matrix, so a path costs nothing
+ * per row once the data has been accumulated.
+ *
+ * Ridge (alpha = 0) paths reuse one eigendecomposition of the scaled Gram
+ * matrix: each lambda is then O(n^2). Lasso and elastic-net paths run
+ * cyclic coordinate descent with covariance updates, warm-started from the
+ * previous lambda, on a working set chosen by the sequential strong rule
+ * and verified by the KKT conditions.
+ */
+class RegularizedRegression {
+private:
+    int mNumFeatures;
+    long long mNumRows;
+    Matrix mGram;               // D X^T X D / m
+    Vector mCorrelations;       // D X^T y / m
+    Vector mScale;              // D, 0 for a feature that is identically zero
+    double mTargetMeanSquare;   // y^T y / m
+    mutable std::unique_ptr<SymmetricEigenSolver> mpEigen;   // Built on the first ridge path, then reused
+    mutable std::once_flag mEigenOnce;
+
+    const SymmetricEigenSolver& GetEigenSolver() const;
+
+    double TrainRMSE(const double* scaledCoefficients) const;
+    void StorePathPoint(RegularizationPath& path, int point, const std::vector<double>& scaledCoefficients) const;
+
+public:
+    /**
+     * @param target 1-based target column of the accumulator
+     * @throws std::invalid_argument if no rows were accumulated or target is out of range
+     */
+    explicit RegularizedRegression(const RegressionAccumulator& data, int target = 1);
+    RegularizedRegression(const RegularizedRegression& other) = delete;
+    RegularizedRegression& operator=(const RegularizedRegression& other) = delete;
+
+    int GetNumFeatures() const;
+
+    // Smallest lambda whose lasso/elastic-net solution is all zero
+    // @throws std::invalid_argument unless 0 < alpha <= 1
+    double MaxLambda(double alpha = 1.0) const;
+    // count values from maxLambda down to maxLambda * ratio, evenly spaced in log scale
+    // @throws std::invalid_argument unless maxLambda > 0, 0 < ratio < 1 and count >= 2
+    static Vector LambdaGrid(double maxLambda, double ratio = 1e-3, int count = 50);
+
+    /**
+     * Ridge solutions (S + lambda I) b = c for every lambda. Safe to call
+     * from several threads; the eigendecomposition is built once.
+     * @throws std::invalid_argument if a lambda is negative
+     * @throws std::runtime_error if S + lambda I is singular for some lambda
+     */
+    RegularizationPath RidgePath(const Vector& lambdas) const;
+    /**
+     * Elastic-net solutions along a decreasing lambda grid
+     * @throws std::invalid_argument unless 0 <= alpha <= 1 and the lambdas are positive and decreasing
+     */
+    RegularizationPath ElasticNetPath(const Vector& lambdas, double alpha = 1.0,
+                                      const CoordinateDescentOptions& options = CoordinateDescentOptions()) const;
+};
+
+#endif // REGULARIZED_REGRESSION_H
@@ -0,0 +1,64 @@
+#ifndef SINGULAR_VALUE_DECOMPOSITION_H
+#define SINGULAR_VALUE_DECOMPOSITION_H
+
+#include "Matrix.h"
+#include "Vector.h"
+
+/**
+ * Thin singular value decomposition A = U diag(s) V^T with the singular
+ * values in descending order. U is m x k, V is n x k.
+ *
+ * The full decomposition (k = min(m, n)) uses one-sided Jacobi rotations,
+ * which are accurate even for tiny singular values. Tall inputs are first
+ * reduced to their n x n R factor by Householder QR, so Jacobi only works on
+ * the small triangle and the cost is O(mn^2). Randomized() computes a
+ * truncated decomposition with k = rank in O(mnk) from a random range finder.
+ *
+ * A tolerance argument below zero selects the default rank cutoff
+ * max(m, n) * eps * s_max.
+ */
+class SingularValueDecomposition {
+private:
+    int mNumRows;
+    int mNumCols;
+    Matrix mU;
+    Vector mSingularValues;
+    Matrix mV;
+
+    SingularValueDecomposition();
+    void Compute(const Matrix& A);
+    void ComputeTall(const Matrix& A);
+    double ResolveTolerance(double tolerance) const;
+
+public:
+    // @throws std::invalid_argument if A is empty
+    explicit SingularValueDecomposition(const Matrix& A);
+
+    /**
+     * Truncated SVD of the leading rank singular triplets.
+     * @param oversampling Extra random directions, improves accuracy
+     * @param powerIterations Passes of (A A^T) that sharpen a slowly decaying spectrum
+     * @param seed Seed of the Gaussian test matrix (results are reproducible)
+     * @throws std::invalid_argument unless 0 < rank <= min(m, n)
+     */
+    static SingularValueDecomposition Randomized(const Matrix& A, int rank, int oversampling = 10,
+                                                 int powerIterations = 2, unsigned int seed = 0);
+
+    int GetNumRows() const;
+    int GetNumCols() const;
+    const Matrix& GetU() const;
+    const Vector& GetSingularValues() const;
+    const Matrix& GetV() const;
+
+    // Number of singular values above the tolerance
+    int GetRank(double tolerance = -1.0) const;
+    // s_max / s_min of the computed values (infinite if s_min is zero)
+    double ConditionNumber() const;
+
+    // V diag(1/s) U^T with singular values at or below the tolerance dropped
+    Matrix PseudoInverse(double tolerance = -1.0) const;
+    // Minimum-norm least-squares solution, without forming the pseudo-inverse
+    Vector Solve(const Vector& b, double tolerance = -1.0) const;
+};
+
+#endif // SINGULAR_VALUE_DECOMPOSITION_H
@@ -0,0 +1,90 @@
+#ifndef SPARSE_MATRIX_H
+#define SPARSE_MATRIX_H
+
+#include "LinearOperator.h"
+#include "Matrix.h"
+#include "Vector.h"
+#include <vector>
+
+class SparseMatrix;
+
+/**
+ * Coordinate (COO) list of entries used to assemble a SparseMatrix.
+ * Entries may be added in any order; duplicates are summed by Build().
+ */
+class SparseMatrixBuilder {
+private:
+    int mNumRows;
+    int mNumCols;
+    std::vector<int> mRows;      // 0-based
+    std::vector<int> mCols;      // 0-based
+    std::vector<double> mValues;
+
+    friend class SparseMatrix;
+
+public:
+    SparseMatrixBuilder(int numRows, int numCols);
+
+    void Reserve(int numEntries);
+    void Add(int i, int j, double value);   // 1-based, like Matrix::operator()
+
+    int GetNumRows() const;
+    int GetNumCols() const;
+    int GetNumEntries() const;
+
+    SparseMatrix Build() const;
+};
+
+/**
+ * Compressed sparse row matrix. Row i (0-based) holds the entries
+ * GetValues()[k] at columns GetColumnIndices()[k] for
+ * GetRowPointers()[i] <= k < GetRowPointers()[i + 1], with the columns of
+ * each row sorted and unique. Storage and products cost O(nonzeros).
+ */
+class SparseMatrix final : public LinearOperator {
+private:
+    int mNumRows;
+    int mNumCols;
+    std::vector<int> mRowPointers;     // mNumRows + 1 offsets into the arrays below
+    std::vector<int> mColumnIndices;
+    std::vector<double> mValues;
+
+public:
+    SparseMatrix();
+    SparseMatrix(int numRows, int numCols);   // All zeros
+    explicit SparseMatrix(const SparseMatrixBuilder& builder);
+
+    // Keeps the entries with |a_ij| > dropTolerance
+    static SparseMatrix FromDense(const Matrix& A, double dropTolerance = 0.0);
+    Matrix ToDense() const;
+
+    // Accessors
+    int GetNumRows() const override;
+    int GetNumCols() const override;
+    int GetNumNonZeros() const;
+    double operator()(int i, int j) const;   // 1-based; zero outside the pattern
+
+    const std::vector<int>& GetRowPointers() const;
+    const std::vector<int>& GetColumnIndices() const;
+    const std::vector<double>& GetValues() const;
+
+    // result = (*this) * vec, writing into an existing vector of matching size
+    void Multiply(const Vector& vec, Vector& result) const;
+    // result = (*this)^T * vec without forming the transpose
+    void MultiplyTranspose(const Vector& vec, Vector& result) const;
+    Vector operator*(const Vector& vec) const;
+
+    // LinearOperator interface (same as Multiply / MultiplyTranspose)
+    void Apply(const Vector& x, Vector& y) const override;
+    void ApplyTranspose(const Vector& x, Vector& y) const override;
+
+    SparseMatrix Transpose() const;
+    Vector Diagonal() const;   // Zero where the diagonal is not stored
+
+    // Utility functions
+    bool IsSquare() const;
+    bool IsSymmetric() const;
+    void Print() const;
+};
+
+#endif // SPARSE_MATRIX_H
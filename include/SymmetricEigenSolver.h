@@ -0,0 +1,71 @@
+#ifndef SYMMETRIC_EIGEN_SOLVER_H
+#define SYMMETRIC_EIGEN_SOLVER_H
+
+#include "LinearOperator.h"
+#include "Matrix.h"
+#include "Vector.h"
+
+/**
+ * All eigenvalues (and optionally eigenvectors) of a dense symmetric matrix.
+ *
+ * A is reduced to tridiagonal form by Householder similarity transforms and
+ * the tridiagonal matrix is diagonalized by the implicit QL algorithm with
+ * Wilkinson shifts, O(n^3) in total. Only the lower triangle of A is read.
+ * Eigenvalues are returned in ascending order; column j of
+ * GetEigenvectors() belongs to eigenvalue j.
+ */
+class SymmetricEigenSolver {
+private:
+    int mSize;
+    Vector mEigenvalues;
+    Matrix mEigenvectors;
+    bool mHasEigenvectors;
+
+public:
+    // @throws std::invalid_argument if A is not square
+    // @throws std::runtime_error if the QL iteration does not converge
+    explicit SymmetricEigenSolver(const Matrix& A, bool computeEigenvectors = true);
+
+    int GetSize() const;
+    const Vector& GetEigenvalues() const;
+    // @throws std::logic_error if the eigenvectors were not requested
+    const Matrix& GetEigenvectors() const;
+
+    double GetMinEigenvalue() const;
+    double GetMaxEigenvalue() const;
+
+    // lambda_min > n * eps * |lambda|_max, i.e. positive beyond rounding
+    bool IsPositiveDefinite() const;
+    // |lambda|_max / |lambda|_min (infinite for a singular matrix)
+    double ConditionNumber() const;
+};
+
+struct LanczosOptions {
+    int maxIterations;     // Krylov dimension cap; 0 selects min(n, 200)
+    double tolerance;      // Ritz residual relative to the largest Ritz value
+    unsigned int seed;     // Seed of the random start vector
+
+    LanczosOptions() : maxIterations(0), tolerance(1e-8), seed(0) {}
+};
+
+struct LanczosResult {
+    Vector smallest;       // Ascending
+    Vector largest;        // Descending
+    int iterations;
+    bool converged;        // All requested Ritz values met the tolerance
+};
+
+/**
+ * Extreme eigenvalues of a symmetric operator by the Lanczos method with
+ * full reorthogonalization. Only products A * q are needed, so A may be
+ * sparse or matrix-free. Each iteration costs one product plus O(nk).
+ * @param count Number of eigenvalues wanted at each end of the spectrum
+ * @throws std::invalid_argument if A is not square or count is out of range
+ */
+LanczosResult LanczosExtremeEigenvalues(const LinearOperator& A, int count,
+                                        const LanczosOptions& options = LanczosOptions());
+
+// lambda_max / lambda_min of a symmetric positive definite operator, by Lanczos
+double EstimateConditionNumber(const LinearOperator& A);
+
+#endif // SYMMETRIC_EIGEN_SOLVER_H
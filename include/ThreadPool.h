@@ -0,0 +1,63 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Small fork-join pool used by the Matrix and solver kernels.
+ *
+ * The process-wide instance returned by Global() is sized from the
+ * TINYPROJECT_NUM_THREADS environment variable, falling back to the number
+ * of hardware threads, and can be resized with SetNumThreads(). The calling
+ * thread always takes part in the work, so a pool of size 1 has no workers
+ * and runs everything inline.
+ */
+class ThreadPool {
+private:
+    struct Job;
+
+    int mNumThreads;
+    std::vector<std::thread> mWorkers;
+    std::mutex mMutex;                 // Guards mJob, mGeneration, mStop
+    std::mutex mDispatchMutex;         // One ParallelFor at a time
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+    Job* mJob;
+    unsigned long mGeneration;
+    bool mStop;
+
+    void StartWorkers();
+    void StopWorkers();
+    void WorkerLoop();
+    static void RunChunks(Job& job);
+
+public:
+    explicit ThreadPool(int numThreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+
+    static ThreadPool& Global();
+
+    int GetNumThreads() const;
+    // Resizes the pool (values < 1 are treated as 1). Must not be called
+    // while a ParallelFor is running on this pool.
+    void SetNumThreads(int numThreads);
+
+    /**
+     * Calls body(chunkBegin, chunkEnd) over disjoint chunks covering
+     * [begin, end), each at least minChunk long, and returns when all are
+     * done. Runs inline when the range yields a single chunk, when the pool
+     * has one thread, when called from inside a pool task, or while another
+     * thread is dispatching. The first exception thrown by body is rethrown.
+     */
+    void ParallelFor(int begin, int end, int minChunk,
+                     const std::function<void(int, int)>& body);
+};
+
+#endif // THREAD_POOL_H
@@ -1,16 +1,27 @@
 #ifndef VECTOR_H
 #define VECTOR_H
 
-class Vector {
+#include "VectorExpression.h"
+#include <utility>
+
+class Vector : public VectorExpression<Vector> {
 private:
     int mSize;
     double* mData;
 
+    static double* Allocate(int size);   // Uninitialized; throws std::runtime_error on failure
+    template <typename E>
+    void Evaluate(const E& expression);
+
 public:
     // Constructors and destructor
     Vector();
     Vector(int size);
     Vector(const Vector& other);
+    Vector(Vector&& other) noexcept;
+    // Evaluates an expression such as a + 2.0 * b in one pass
+    template <typename E>
+    Vector(const VectorExpression<E>& expression);
     ~Vector();
 
     // Accessors
@@ -19,18 +30,30 @@ public:
     const double& operator()(int i) const; // 1-based indexing const version
     double& operator[](int i);             // 0-based indexing with bounds checking
     const double& operator[](int i) const; // 0-based indexing const version
+    double* GetData();                     // Raw contiguous storage for kernels
+    const double* GetData() const;
+    double Element(int i) const { return mData[i]; }   // 0-based, unchecked (expression leaf)
 
-    // Assignment operator
+    // Assignment operators
     Vector& operator=(const Vector& other);
+    Vector& operator=(Vector&& other) noexcept;
+    template <typename E>
+    Vector& operator=(const VectorExpression<E>& expression);
+
+    // In-place operators (no allocation)
+    Vector& operator+=(const Vector& other);
+    Vector& operator-=(const Vector& other);
+    Vector& operator*=(double scalar);
+    Vector& Axpy(double alpha, const Vector& x); // *this += alpha * x
+    template <typename E>
+    Vector& operator+=(const VectorExpression<E>& expression);
+    template <typename E>
+    Vector& operator-=(const VectorExpression<E>& expression);
 
-    // Unary operators
+    // Unary plus copies; negation, +, - and scaling are the lazy expressions
+    // of VectorExpression.h
     Vector operator+() const;
-    Vector operator-() const;
 
-    // Binary operators
-    Vector operator+(const Vector& other) const;
-    Vector operator-(const Vector& other) const;
-    Vector operator*(double scalar) const;
     double operator*(const Vector& other) const; // Dot product
 
     // Other operations
@@ -38,7 +61,68 @@ public:
     void Print() const;
 };
 
-// Non-member function for scalar multiplication
-Vector operator*(double scalar, const Vector& vec);
+// Exact match for v * s; the template alone would tie with the dot product,
+// whose Vector argument a double reaches through Vector(int)
+inline VectorScaledExpression<Vector> operator*(const Vector& vec, double scalar) {
+    return VectorScaledExpression<Vector>(scalar, vec);
+}
+
+template <typename E>
+void Vector::Evaluate(const E& expression) {
+    double* data = mData;
+    const int size = mSize;
+    int i = 0;
+    for (; i + kExpressionBlock <= size; i += kExpressionBlock) {
+        const double x0 = expression.Element(i);
+        const double x1 = expression.Element(i + 1);
+        const double x2 = expression.Element(i + 2);
+        const double x3 = expression.Element(i + 3);
+        data[i] = x0;
+        data[i + 1] = x1;
+        data[i + 2] = x2;
+        data[i + 3] = x3;
+    }
+    for (; i < size; i++) data[i] = expression.Element(i);
+}
+
+template <typename E>
+Vector::Vector(const VectorExpression<E>& expression)
+    : mSize(expression.GetSize()), mData(Allocate(expression.GetSize())) {
+    Evaluate(expression.Derived());
+}
+
+// Same size: evaluated in place, which is safe even if this vector appears
+// in the expression. Otherwise the old storage must stay alive while the
+// expression reads it, so the result is built aside and moved in.
+template <typename E>
+Vector& Vector::operator=(const VectorExpression<E>& expression) {
+    if (expression.GetSize() == mSize) {
+        Evaluate(expression.Derived());
+    } else {
+        Vector result(expression);
+        *this = std::move(result);
+    }
+    return *this;
+}
+
+template <typename E>
+Vector& Vector::operator+=(const VectorExpression<E>& expression) {
+    return *this = *this + expression;
+}
+
+template <typename E>
+Vector& Vector::operator-=(const VectorExpression<E>& expression) {
+    return *this = *this - expression;
+}
+
+template <typename E>
+double VectorExpression<E>::Norm() const {
+    return Vector(*this).Norm();
+}
+
+template <typename E>
+void VectorExpression<E>::Print() const {
+    Vector(*this).Print();
+}
 
 #endif // VECTOR_H
\ No newline at end of file
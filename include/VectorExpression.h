@@ -0,0 +1,106 @@
+#ifndef VECTOR_EXPRESSION_H
+#define VECTOR_EXPRESSION_H
+
+#include <stdexcept>
+
+class Vector;
+
+// Fused loops are written four elements at a time with all four loaded
+// before any is stored. Expressions are elementwise, so even when the target
+// also appears on the right-hand side the stores cannot change a value that
+// is still to be read, and the compiler can pack each block into vector
+// instructions without proving that the operands do not alias.
+const int kExpressionBlock = 4;
+
+/**
+ * Base of the lazy elementwise vector expressions (CRTP). Operators on
+ * vectors build a tree of these nodes instead of temporaries; the tree is
+ * evaluated in a single loop when it is assigned to, or converted to, a
+ * Vector. E provides GetSize() and Element(i) (0-based).
+ */
+template <typename E>
+class VectorExpression {
+public:
+    const E& Derived() const { return static_cast<const E&>(*this); }
+    int GetSize() const { return Derived().GetSize(); }
+    double Element(int i) const { return Derived().Element(i); }
+
+    // Evaluate into a Vector first (defined in Vector.h)
+    double Norm() const;
+    void Print() const;
+};
+
+// Vectors are held by reference inside an expression, nodes by value, so a
+// tree is a few pointers and scalars that live until the end of the statement
+template <typename E>
+struct VectorOperand {
+    typedef const E Type;
+};
+
+template <>
+struct VectorOperand<Vector> {
+    typedef const Vector& Type;
+};
+
+struct ExpressionAdd {
+    static double Apply(double a, double b) { return a + b; }
+};
+
+struct ExpressionSubtract {
+    static double Apply(double a, double b) { return a - b; }
+};
+
+template <typename L, typename R, typename Op>
+class VectorBinaryExpression : public VectorExpression<VectorBinaryExpression<L, R, Op> > {
+private:
+    typename VectorOperand<L>::Type mLeft;
+    typename VectorOperand<R>::Type mRight;
+
+public:
+    VectorBinaryExpression(const L& left, const R& right) : mLeft(left), mRight(right) {
+        if (left.GetSize() != right.GetSize()) throw std::invalid_argument("Vector sizes must match");
+    }
+    int GetSize() const { return mLeft.GetSize(); }
+    double Element(int i) const { return Op::Apply(mLeft.Element(i), mRight.Element(i)); }
+};
+
+template <typename E>
+class VectorScaledExpression : public VectorExpression<VectorScaledExpression<E> > {
+private:
+    double mScalar;
+    typename VectorOperand<E>::Type mOperand;
+
+public:
+    VectorScaledExpression(double scalar, const E& operand) : mScalar(scalar), mOperand(operand) {}
+    int GetSize() const { return mOperand.GetSize(); }
+    double Element(int i) const { return mScalar * mOperand.Element(i); }
+};
+
+template <typename L, typename R>
+inline VectorBinaryExpression<L, R, ExpressionAdd>
+operator+(const VectorExpression<L>& left, const VectorExpression<R>& right) {
+    return VectorBinaryExpression<L, R, ExpressionAdd>(left.Derived(), right.Derived());
+}
+
+template <typename L, typename R>
+inline VectorBinaryExpression<L, R, ExpressionSubtract>
+operator-(const VectorExpression<L>& left, const VectorExpression<R>& right) {
+    return VectorBinaryExpression<L, R, ExpressionSubtract>(left.Derived(), right.Derived());
+}
+
+template <typename E>
+inline VectorScaledExpression<E> operator-(const VectorExpression<E>& operand) {
+    return VectorScaledExpression<E>(-1.0, operand.Derived());
+}
+
+template <typename E>
+inline VectorScaledExpression<E> operator*(double scalar, const VectorExpression<E>& operand) {
+    return VectorScaledExpression<E>(scalar, operand.Derived());
+}
+
+template <typename E>
+inline VectorScaledExpression<E> operator*(const VectorExpression<E>& operand, double scalar) {
+    return VectorScaledExpression<E>(scalar, operand.Derived());
+}
+
+#endif // VECTOR_EXPRESSION_H
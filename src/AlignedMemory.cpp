@@ -0,0 +1,32 @@
+#include "AlignedMemory.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+void* AllocateAligned(std::size_t bytes, std::size_t alignment) {
+    if (bytes == 0) return nullptr;
+#ifdef _WIN32
+    void* ptr = _aligned_malloc(bytes, alignment);
+    if (!ptr) throw std::bad_alloc();
+#else
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, alignment, bytes) != 0) throw std::bad_alloc();
+#endif
+    return ptr;
+}
+
+void FreeAligned(void* ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+int PaddedStride(int numCols, std::size_t elementSize) {
+    const int perLine = static_cast<int>(kMemoryAlignment / elementSize);
+    return ((numCols + perLine - 1) / perLine) * perLine;
+}
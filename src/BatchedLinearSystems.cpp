@@ -0,0 +1,330 @@
+#include "BatchedLinearSystems.h"
+#include "AlignedMemory.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BATCHED_HAVE_AVX2_KERNEL 1
+#endif
+
+// The kernel bodies are force-inlined into one generic and one AVX2 entry
+// point, so the same source is compiled for both instruction sets
+#if defined(__GNUC__)
+#define BATCHED_INLINE inline __attribute__((always_inline))
+#else
+#define BATCHED_INLINE inline
+#endif
+
+namespace {
+
+const int kLanes = BatchedLinearSystems::kLanes;
+
+// Pivots below this magnitude mark a system as singular (as in LUFactorization)
+const double kSingularThreshold = 1e-10;
+
+// Floating-point operations per parallel task, roughly
+const double kTaskWork = 65536.0;
+
+enum SystemStatus : unsigned char {
+    kNotSolved,
+    kSolved,
+    kFailed
+};
+
+// y[l] -= f[l] * x[l] over the lanes of one block. The fixed trip count and
+// the restrict qualifiers (rows of a block never overlap) let the compiler
+// turn this into whole-register operations.
+BATCHED_INLINE void LanesSubtractProduct(double* __restrict y, const double* __restrict f,
+                                         const double* __restrict x) {
+    for (int l = 0; l < kLanes; l++) y[l] -= f[l] * x[l];
+}
+
+BATCHED_INLINE void LanesScale(double* __restrict y, const double* __restrict f) {
+    for (int l = 0; l < kLanes; l++) y[l] *= f[l];
+}
+
+// Pointers to the lanes of element (i, j) and right-hand side entry i of one block
+struct BlockView {
+    double* a;
+    double* b;
+    int n;
+
+    double* A(int i, int j) const { return a + (i * n + j) * kLanes; }
+    double* B(int i) const { return b + i * kLanes; }
+};
+
+// Back substitution with the upper triangle (the row stride of U is n), then
+// NaN for the failed lanes
+BATCHED_INLINE void BackSubstituteUpper(const BlockView& v, const bool* failed) {
+    const int n = v.n;
+    for (int i = n - 1; i >= 0; i--) {
+        double* bi = v.B(i);
+        for (int j = i + 1; j < n; j++) LanesSubtractProduct(bi, v.A(i, j), v.B(j));
+        double inverse[kLanes];
+        const double* aii = v.A(i, i);
+        for (int l = 0; l < kLanes; l++) inverse[l] = failed[l] ? 0.0 : 1.0 / aii[l];
+        LanesScale(bi, inverse);
+    }
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (int i = 0; i < n; i++) {
+        double* bi = v.B(i);
+        for (int l = 0; l < kLanes; l++) {
+            if (failed[l]) bi[l] = nan;
+        }
+    }
+}
+
+// Gaussian elimination of one block with the right-hand sides carried along.
+// The pivot search and row swaps differ per lane and run lane by lane
+// (O(n^2)); the O(n^3) elimination runs across lanes.
+BATCHED_INLINE void SolveLUBlockBody(const BlockView& v, bool* failed) {
+    const int n = v.n;
+    for (int l = 0; l < kLanes; l++) failed[l] = false;
+
+    for (int k = 0; k < n; k++) {
+        for (int l = 0; l < kLanes; l++) {
+            int pivot = k;
+            double maxVal = std::abs(v.A(k, k)[l]);
+            for (int r = k + 1; r < n; r++) {
+                const double value = std::abs(v.A(r, k)[l]);
+                if (value > maxVal) {
+                    maxVal = value;
+                    pivot = r;
+                }
+            }
+            if (maxVal < kSingularThreshold) failed[l] = true;
+            if (pivot != k) {
+                for (int j = k; j < n; j++) std::swap(v.A(k, j)[l], v.A(pivot, j)[l]);
+                std::swap(v.B(k)[l], v.B(pivot)[l]);
+            }
+        }
+
+        double inverse[kLanes];
+        const double* akk = v.A(k, k);
+        for (int l = 0; l < kLanes; l++) inverse[l] = failed[l] ? 0.0 : 1.0 / akk[l];
+        for (int i = k + 1; i < n; i++) {
+            double factor[kLanes];
+            const double* aik = v.A(i, k);
+            for (int l = 0; l < kLanes; l++) factor[l] = aik[l] * inverse[l];
+            for (int j = k + 1; j < n; j++) LanesSubtractProduct(v.A(i, j), factor, v.A(k, j));
+            LanesSubtractProduct(v.B(i), factor, v.B(k));
+        }
+    }
+    BackSubstituteUpper(v, failed);
+}
+
+// Right-looking Cholesky A = L L^T of one block, L over the lower triangle,
+// followed by L y = b and L^T x = y. L^T is written into the upper triangle
+// so the back substitution can be shared with LU.
+BATCHED_INLINE void SolveCholeskyBlockBody(const BlockView& v, bool* failed) {
+    const int n = v.n;
+    for (int l = 0; l < kLanes; l++) failed[l] = false;
+
+    for (int j = 0; j < n; j++) {
+        double* ajj = v.A(j, j);
+        for (int k = 0; k < j; k++) LanesSubtractProduct(ajj, v.A(j, k), v.A(j, k));
+        double inverse[kLanes];
+        for (int l = 0; l < kLanes; l++) {
+            if (!(ajj[l] > 0.0)) failed[l] = true;
+            ajj[l] = failed[l] ? 1.0 : std::sqrt(ajj[l]);
+            inverse[l] = 1.0 / ajj[l];
+        }
+        for (int i = j + 1; i < n; i++) {
+            double* aij = v.A(i, j);
+            for (int k = 0; k < j; k++) LanesSubtractProduct(aij, v.A(i, k), v.A(j, k));
+            LanesScale(aij, inverse);
+        }
+    }
+
+    // Forward substitution with L
+    for (int i = 0; i < n; i++) {
+        double* bi = v.B(i);
+        for (int k = 0; k < i; k++) LanesSubtractProduct(bi, v.A(i, k), v.B(k));
+        double inverse[kLanes];
+        const double* aii = v.A(i, i);
+        for (int l = 0; l < kLanes; l++) inverse[l] = 1.0 / aii[l];
+        LanesScale(bi, inverse);
+    }
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            double* upper = v.A(i, j);
+            const double* lower = v.A(j, i);
+            for (int l = 0; l < kLanes; l++) upper[l] = lower[l];
+        }
+    }
+    BackSubstituteUpper(v, failed);
+}
+
+typedef void (*BlockKernel)(const BlockView& v, bool* failed);
+
+void SolveLUBlockGeneric(const BlockView& v, bool* failed) { SolveLUBlockBody(v, failed); }
+void SolveCholeskyBlockGeneric(const BlockView& v, bool* failed) { SolveCholeskyBlockBody(v, failed); }
+
+#ifdef BATCHED_HAVE_AVX2_KERNEL
+__attribute__((target("avx2,fma")))
+void SolveLUBlockAvx2(const BlockView& v, bool* failed) { SolveLUBlockBody(v, failed); }
+__attribute__((target("avx2,fma")))
+void SolveCholeskyBlockAvx2(const BlockView& v, bool* failed) { SolveCholeskyBlockBody(v, failed); }
+#endif
+
+bool UseAvx2() {
+#ifdef BATCHED_HAVE_AVX2_KERNEL
+    static const bool supported = []() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+BatchedLinearSystems::BatchedLinearSystems(int size, int count)
+    : mSize(size), mCount(count), mNumBlocks(0), mpMatrices(nullptr), mpRhs(nullptr), mStatus() {
+    if (size <= 0 || count <= 0) {
+        throw std::invalid_argument("Batch dimensions must be positive");
+    }
+    mNumBlocks = (count + kLanes - 1) / kLanes;
+    const std::size_t matrixCount = static_cast<std::size_t>(mNumBlocks) * size * size * kLanes;
+    const std::size_t rhsCount = static_cast<std::size_t>(mNumBlocks) * size * kLanes;
+    mpMatrices = static_cast<double*>(AllocateAligned(matrixCount * sizeof(double)));
+    try {
+        mpRhs = static_cast<double*>(AllocateAligned(rhsCount * sizeof(double)));
+    } catch (...) {
+        FreeAligned(mpMatrices);
+        throw;
+    }
+    std::fill(mpMatrices, mpMatrices + matrixCount, 0.0);
+    std::fill(mpRhs, mpRhs + rhsCount, 0.0);
+    mStatus.assign(count, kNotSolved);
+}
+
+BatchedLinearSystems::~BatchedLinearSystems() {
+    FreeAligned(mpMatrices);
+    FreeAligned(mpRhs);
+}
+
+int BatchedLinearSystems::GetSize() const { return mSize; }
+int BatchedLinearSystems::GetCount() const { return mCount; }
+int BatchedLinearSystems::GetNumBlocks() const { return mNumBlocks; }
+double* BatchedLinearSystems::GetMatrixData() { return mpMatrices; }
+const double* BatchedLinearSystems::GetMatrixData() const { return mpMatrices; }
+double* BatchedLinearSystems::GetRhsData() { return mpRhs; }
+const double* BatchedLinearSystems::GetRhsData() const { return mpRhs; }
+
+void BatchedLinearSystems::CheckSystem(int system) const {
+    if (system < 0 || system >= mCount) {
+        throw std::out_of_range("System index out of range");
+    }
+}
+
+/**
+ * Copies A and b into the slots of one system
+ * @param system 0-based index of the system
+ * @throws std::out_of_range if system is not in [0, count)
+ * @throws std::invalid_argument if A is not n x n or b does not have n entries
+ */
+void BatchedLinearSystems::SetSystem(int system, const Matrix& A, const Vector& b) {
+    CheckSystem(system);
+    if (A.GetNumRows() != mSize || A.GetNumCols() != mSize || b.GetSize() != mSize) {
+        throw std::invalid_argument("System dimensions do not match the batch");
+    }
+    const int n = mSize;
+    const int block = system / kLanes;
+    const int lane = system % kLanes;
+    double* matrix = mpMatrices + static_cast<std::size_t>(block) * n * n * kLanes + lane;
+    double* rhs = mpRhs + static_cast<std::size_t>(block) * n * kLanes + lane;
+    const double* a = A.GetData();
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            matrix[(i * n + j) * kLanes] = a[static_cast<std::size_t>(i) * A.GetStride() + j];
+        }
+        rhs[i * kLanes] = b[i];
+    }
+    mStatus[system] = kNotSolved;
+}
+
+// Runs the kernel on every block of lanes; blocks are independent, so the
+// result does not depend on the number of threads
+template <typename Kernel>
+void BatchedLinearSystems::SolveBlocks(Kernel kernel) {
+    const int n = mSize;
+    const double blockWork = static_cast<double>(n) * n * n * kLanes;
+    const int grain = std::max(1, static_cast<int>(kTaskWork / blockWork));
+    ThreadPool::Global().ParallelFor(0, mNumBlocks, grain, [&](int first, int last) {
+        for (int block = first; block < last; block++) {
+            const int firstLane = block * kLanes;
+            BlockView view = { mpMatrices + static_cast<std::size_t>(block) * n * n * kLanes,
+                               mpRhs + static_cast<std::size_t>(block) * n * kLanes, n };
+            bool failed[kLanes];
+            kernel(view, failed);
+            const int lanes = std::min(kLanes, mCount - firstLane);
+            for (int l = 0; l < lanes; l++) {
+                mStatus[firstLane + l] = failed[l] ? kFailed : kSolved;
+            }
+        }
+    });
+}
+
+/**
+ * Solves every system by LU with partial pivoting. Singular systems are
+ * marked as failed; the others are unaffected.
+ */
+void BatchedLinearSystems::SolveLU() {
+    BlockKernel kernel = SolveLUBlockGeneric;
+#ifdef BATCHED_HAVE_AVX2_KERNEL
+    if (UseAvx2()) kernel = SolveLUBlockAvx2;
+#endif
+    SolveBlocks(kernel);
+}
+
+/**
+ * Solves every system by Cholesky factorization. Systems that are not
+ * positive definite are marked as failed; the others are unaffected.
+ */
+void BatchedLinearSystems::SolveCholesky() {
+    BlockKernel kernel = SolveCholeskyBlockGeneric;
+#ifdef BATCHED_HAVE_AVX2_KERNEL
+    if (UseAvx2()) kernel = SolveCholeskyBlockAvx2;
+#endif
+    SolveBlocks(kernel);
+}
+
+bool BatchedLinearSystems::IsSolved(int system) const {
+    CheckSystem(system);
+    return mStatus[system] == kSolved;
+}
+
+int BatchedLinearSystems::GetNumFailed() const {
+    return static_cast<int>(std::count(mStatus.begin(), mStatus.end(), static_cast<unsigned char>(kFailed)));
+}
+
+/**
+ * Copies the solution of one system out of the interleaved layout
+ * @param system 0-based index of the system
+ * @throws std::out_of_range if system is not in [0, count)
+ * @throws std::runtime_error if the system was not solved or is singular
+ */
+Vector BatchedLinearSystems::GetSolution(int system) const {
+    CheckSystem(system);
+    if (mStatus[system] == kNotSolved) {
+        throw std::runtime_error("System has not been solved");
+    }
+    if (mStatus[system] == kFailed) {
+        throw std::runtime_error("Matrix is singular or not positive definite");
+    }
+    const double* rhs = mpRhs + static_cast<std::size_t>(system / kLanes) * mSize * kLanes + system % kLanes;
+    Vector x(mSize);
+    for (int i = 0; i < mSize; i++) x[i] = rhs[i * kLanes];
+    return x;
+}
+
+const char* BatchedLinearSystems::KernelName() {
+    return UseAvx2() ? "avx2-fma" : "generic";
+}
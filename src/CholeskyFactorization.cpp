@@ -0,0 +1,224 @@
+#include "CholeskyFactorization.h"
+#include "Gemm.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+// Panel width of the blocked factorization and triangular solves
+const int kPanelWidth = 64;
+
+// Matrices smaller than this are factorized as one panel
+const int kBlockedMinSize = 128;
+
+// Right-hand-side columns per parallel task in the blocked solves
+const int kColumnGrain = 32;
+}
+
+/**
+ * Factorizes A (lower triangle only)
+ * @param A Square symmetric matrix
+ * @throws std::invalid_argument if A is not square
+ */
+CholeskyFactorization::CholeskyFactorization(const Matrix& A)
+    : mSize(A.GetNumRows()), mL(), mPositiveDefinite(true) {
+    if (!A.IsSquare()) {
+        throw std::invalid_argument("Matrix must be square for Cholesky factorization");
+    }
+    mL = A;
+    Factorize();
+}
+
+int CholeskyFactorization::GetSize() const { return mSize; }
+bool CholeskyFactorization::IsPositiveDefinite() const { return mPositiveDefinite; }
+const Matrix& CholeskyFactorization::GetL() const { return mL; }
+
+double CholeskyFactorization::LogDeterminant() const {
+    CheckSolvable(mSize);
+    double logDet = 0.0;
+    for (int i = 0; i < mSize; i++) {
+        logDet += std::log(mL.GetData()[static_cast<std::size_t>(i) * mL.GetStride() + i]);
+    }
+    return 2.0 * logDet;
+}
+
+void CholeskyFactorization::Factorize() {
+    const int n = mSize;
+    if (n == 0) return;
+    double* a = mL.GetData();
+    const int lda = mL.GetStride();
+    const int nb = (n < kBlockedMinSize) ? n : kPanelWidth;
+    ThreadPool& pool = ThreadPool::Global();
+
+    for (int k0 = 0; k0 < n; k0 += nb) {
+        const int k1 = std::min(n, k0 + nb);
+        if (!FactorizeDiagonalBlock(k0, k1)) {
+            mPositiveDefinite = false;
+            return;
+        }
+        if (k1 >= n) break;
+
+        // L21 = A21 * L11^-T, row by row
+        pool.ParallelFor(k1, n, std::max(1, 8192 / (k1 - k0)), [&](int first, int last) {
+            for (int i = first; i < last; i++) {
+                double* rowI = a + static_cast<std::size_t>(i) * lda;
+                for (int j = k0; j < k1; j++) {
+                    const double* rowJ = a + static_cast<std::size_t>(j) * lda;
+                    double sum = rowI[j];
+                    for (int p = k0; p < j; p++) sum -= rowI[p] * rowJ[p];
+                    rowI[j] = sum / rowJ[j];
+                }
+            }
+        });
+
+        // A22 -= L21 * L21^T on the lower triangle, one block row per task
+        const int numBlockRows = (n - k1 + nb - 1) / nb;
+        pool.ParallelFor(0, numBlockRows, 1, [&](int first, int last) {
+            for (int blockRow = first; blockRow < last; blockRow++) {
+                const int i0 = k1 + blockRow * nb;
+                const int ib = std::min(nb, n - i0);
+                Gemm(false, true, ib, i0 + ib - k1, k1 - k0,
+                     -1.0, a + static_cast<std::size_t>(i0) * lda + k0, lda,
+                     a + static_cast<std::size_t>(k1) * lda + k0, lda,
+                     1.0, a + static_cast<std::size_t>(i0) * lda + k1, lda);
+            }
+        });
+    }
+
+    // Clear the strict upper triangle so GetL() is a proper factor
+    for (int i = 0; i < n; i++) {
+        std::fill(a + static_cast<std::size_t>(i) * lda + i + 1, a + static_cast<std::size_t>(i) * lda + n, 0.0);
+    }
+}
+
+// Unblocked Cholesky of the (already updated) diagonal block [k0, k1)
+bool CholeskyFactorization::FactorizeDiagonalBlock(int k0, int k1) {
+    double* a = mL.GetData();
+    const int lda = mL.GetStride();
+    for (int j = k0; j < k1; j++) {
+        double* rowJ = a + static_cast<std::size_t>(j) * lda;
+        double d = rowJ[j];
+        for (int p = k0; p < j; p++) d -= rowJ[p] * rowJ[p];
+        if (!(d > 0.0)) return false;   // Also rejects NaN
+        const double ljj = std::sqrt(d);
+        rowJ[j] = ljj;
+        for (int i = j + 1; i < k1; i++) {
+            double* rowI = a + static_cast<std::size_t>(i) * lda;
+            double sum = rowI[j];
+            for (int p = k0; p < j; p++) sum -= rowI[p] * rowJ[p];
+            rowI[j] = sum / ljj;
+        }
+    }
+    return true;
+}
+
+void CholeskyFactorization::CheckSolvable(int rhsRows) const {
+    if (mSize == 0) {
+        throw std::runtime_error("Cholesky factorization is empty");
+    }
+    if (rhsRows != mSize) {
+        throw std::invalid_argument("Right-hand side size does not match the factorized matrix");
+    }
+    if (!mPositiveDefinite) {
+        throw std::runtime_error("Matrix is not positive definite");
+    }
+}
+
+/**
+ * Solves Ax = b by forward substitution with L and back substitution with L^T
+ * @param b Right-hand side
+ * @return Solution vector x
+ * @throws std::runtime_error if the matrix is not positive definite
+ */
+Vector CholeskyFactorization::Solve(const Vector& b) const {
+    CheckSolvable(b.GetSize());
+    const int n = mSize;
+    const double* l = mL.GetData();
+    const int lda = mL.GetStride();
+
+    Vector x(b);
+    double* px = x.GetData();
+    for (int i = 0; i < n; i++) {
+        const double* row = l + static_cast<std::size_t>(i) * lda;
+        double sum = px[i];
+        for (int j = 0; j < i; j++) sum -= row[j] * px[j];
+        px[i] = sum / row[i];
+    }
+    // L^T is traversed by rows of L: subtract column i's contribution once x_i is known
+    for (int i = n - 1; i >= 0; i--) {
+        const double* row = l + static_cast<std::size_t>(i) * lda;
+        px[i] /= row[i];
+        const double xi = px[i];
+        for (int j = 0; j < i; j++) px[j] -= row[j] * xi;
+    }
+    return x;
+}
+
+/**
+ * Solves AX = B for every column of B
+ * @param B Right-hand sides, one per column
+ * @return Solution matrix X
+ * @throws std::runtime_error if the matrix is not positive definite
+ */
+Matrix CholeskyFactorization::Solve(const Matrix& B) const {
+    CheckSolvable(B.GetNumRows());
+    const int n = mSize;
+    const int r = B.GetNumCols();
+    const double* l = mL.GetData();
+    const int lda = mL.GetStride();
+
+    Matrix X(B);
+    double* x = X.GetData();
+    const int ldx = X.GetStride();
+    ThreadPool& pool = ThreadPool::Global();
+
+    // Forward: L Y = B
+    for (int k0 = 0; k0 < n; k0 += kPanelWidth) {
+        const int k1 = std::min(n, k0 + kPanelWidth);
+        pool.ParallelFor(0, r, kColumnGrain, [&](int first, int last) {
+            for (int i = k0; i < k1; i++) {
+                double* rowI = x + static_cast<std::size_t>(i) * ldx;
+                for (int p = k0; p < i; p++) {
+                    const double lip = l[static_cast<std::size_t>(i) * lda + p];
+                    const double* rowP = x + static_cast<std::size_t>(p) * ldx;
+                    for (int j = first; j < last; j++) rowI[j] -= lip * rowP[j];
+                }
+                const double inv = 1.0 / l[static_cast<std::size_t>(i) * lda + i];
+                for (int j = first; j < last; j++) rowI[j] *= inv;
+            }
+        });
+        if (k1 < n) {
+            Gemm(false, false, n - k1, r, k1 - k0,
+                 -1.0, l + static_cast<std::size_t>(k1) * lda + k0, lda,
+                 x + static_cast<std::size_t>(k0) * ldx, ldx,
+                 1.0, x + static_cast<std::size_t>(k1) * ldx, ldx);
+        }
+    }
+
+    // Backward: L^T X = Y, bottom block row first
+    for (int k1 = n; k1 > 0; ) {
+        const int k0 = std::max(0, k1 - kPanelWidth);
+        pool.ParallelFor(0, r, kColumnGrain, [&](int first, int last) {
+            for (int i = k1 - 1; i >= k0; i--) {
+                double* rowI = x + static_cast<std::size_t>(i) * ldx;
+                for (int p = i + 1; p < k1; p++) {
+                    const double lpi = l[static_cast<std::size_t>(p) * lda + i];
+                    const double* rowP = x + static_cast<std::size_t>(p) * ldx;
+                    for (int j = first; j < last; j++) rowI[j] -= lpi * rowP[j];
+                }
+                const double inv = 1.0 / l[static_cast<std::size_t>(i) * lda + i];
+                for (int j = first; j < last; j++) rowI[j] *= inv;
+            }
+        });
+        if (k0 > 0) {
+            // X[0:k0] -= L[k0:k1, 0:k0]^T * X[k0:k1]
+            Gemm(true, false, k0, r, k1 - k0,
+                 -1.0, l + static_cast<std::size_t>(k0) * lda, lda,
+                 x + static_cast<std::size_t>(k0) * ldx, ldx,
+                 1.0, x, ldx);
+        }
+        k1 = k0;
+    }
+    return X;
+}
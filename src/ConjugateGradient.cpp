@@ -0,0 +1,70 @@
+#include "ConjugateGradient.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+ConjugateGradientResult ConjugateGradient(const LinearOperator& A, const Vector& b,
+                                          const ConjugateGradientOptions& options,
+                                          const Preconditioner* preconditioner) {
+    const int n = b.GetSize();
+    if (A.GetNumRows() != n || A.GetNumCols() != n) {
+        throw std::invalid_argument("Matrix A and vector b must have compatible dimensions");
+    }
+    if (options.initialGuess && options.initialGuess->GetSize() != n) {
+        throw std::invalid_argument("Initial guess has the wrong size");
+    }
+
+    ConjugateGradientResult result;
+    result.iterations = 0;
+    result.converged = false;
+    result.solution = options.initialGuess ? *options.initialGuess : Vector(n);
+    Vector& x = result.solution;
+
+    const double bNorm = b.Norm();
+    const double target = std::max(options.relativeTolerance * bNorm, options.absoluteTolerance);
+    const int maxIterations = options.maxIterations > 0 ? options.maxIterations : 2 * n;
+
+    // All work vectors are allocated up front; iterations update them in place
+    Vector r(b);
+    Vector Ap(n);
+    if (options.initialGuess) {
+        A.Apply(x, Ap);
+        r -= Ap;
+    }
+    Vector z(n);
+    const Vector& zr = preconditioner ? z : r;   // Unpreconditioned: z is r
+    if (preconditioner) preconditioner->Apply(r, z);
+    Vector p(zr);
+
+    double rz = r * zr;
+    double rNorm = r.Norm();
+    result.converged = rNorm <= target;
+
+    while (!result.converged && result.iterations < maxIterations) {
+        A.Apply(p, Ap);
+        const double pAp = p * Ap;
+        if (!(pAp > 0.0)) break;   // A is not positive definite along p
+        const double alpha = rz / pAp;
+        x.Axpy(alpha, p);
+        r.Axpy(-alpha, Ap);
+        result.iterations++;
+
+        rNorm = r.Norm();
+        if (rNorm <= target) {
+            result.converged = true;
+            break;
+        }
+
+        if (preconditioner) preconditioner->Apply(r, z);
+        const double rzNew = r * zr;
+        p = zr + (rzNew / rz) * p;   // One fused pass over p
+        rz = rzNew;
+    }
+
+    // Report the true residual rather than the recurrence, which can drift
+    A.Apply(x, Ap);
+    r = b - Ap;
+    result.residualNorm = r.Norm();
+    result.relativeResidual = bNorm > 0.0 ? result.residualNorm / bNorm : result.residualNorm;
+    return result;
+}
@@ -0,0 +1,168 @@
+#include "CrossValidation.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace {
+// Unbiased integer in [0, bound). std::uniform_int_distribution and
+// std::shuffle are implementation-defined, so they are not used where a
+// seed must reproduce the same folds everywhere.
+std::uint32_t UniformBelow(std::mt19937& generator, std::uint32_t bound) {
+    const std::uint32_t threshold = (0u - bound) % bound;   // 2^32 mod bound
+    for (;;) {
+        const std::uint32_t draw = static_cast<std::uint32_t>(generator());
+        if (draw >= threshold) return draw % bound;
+    }
+}
+
+void Shuffle(std::vector<int>& values, std::mt19937& generator) {
+    for (std::size_t i = values.size(); i > 1; i--) {
+        std::swap(values[i - 1], values[UniformBelow(generator, static_cast<std::uint32_t>(i))]);
+    }
+}
+
+void Summarize(CrossValidationResult& result, int numTargets) {
+    const int k = static_cast<int>(result.folds.size());
+    result.meanTrainRMSE = Vector(numTargets);
+    result.meanTestRMSE = Vector(numTargets);
+    result.stdDevTestRMSE = Vector(numTargets);
+    for (int f = 0; f < k; f++) {
+        result.meanTrainRMSE += result.folds[f].trainRMSE;
+        result.meanTestRMSE += result.folds[f].testRMSE;
+    }
+    result.meanTrainRMSE *= 1.0 / k;
+    result.meanTestRMSE *= 1.0 / k;
+    if (k < 2) return;
+    for (int t = 1; t <= numTargets; t++) {
+        double sum = 0.0;
+        for (int f = 0; f < k; f++) {
+            const double d = result.folds[f].testRMSE(t) - result.meanTestRMSE(t);
+            sum += d * d;
+        }
+        result.stdDevTestRMSE(t) = std::sqrt(sum / (k - 1));
+    }
+}
+}
+
+CrossValidation::CrossValidation(int numRows, int numFeatures, int numTargets, const RowSource& source)
+    : mNumRows(numRows), mNumFeatures(numFeatures), mNumTargets(numTargets), mSource(source) {
+    if (numRows <= 0 || numFeatures <= 0 || numTargets <= 0) {
+        throw std::invalid_argument("Row, feature and target counts must be positive");
+    }
+}
+
+void CrossValidation::SetStrata(const std::vector<int>& labels) {
+    if (static_cast<int>(labels.size()) != mNumRows) {
+        throw std::invalid_argument("Need one stratum label per row");
+    }
+    mStrata = labels;
+}
+
+// A shuffled permutation of the rows, grouped by stratum when strata are set
+std::vector<int> CrossValidation::StratifiedOrder(std::mt19937& generator) const {
+    std::vector<int> order(mNumRows);
+    for (int i = 0; i < mNumRows; i++) order[i] = i;
+    Shuffle(order, generator);
+    if (!mStrata.empty()) {
+        const std::vector<int>& strata = mStrata;
+        std::stable_sort(order.begin(), order.end(), [&strata](int a, int b) { return strata[a] < strata[b]; });
+    }
+    return order;
+}
+
+/**
+ * Deals a stratified shuffle into folds round-robin
+ * @param numFolds Number of folds k; fold sizes differ by at most one row
+ * @param seed Seed of the shuffle
+ * @return One result per fold
+ * @throws std::invalid_argument unless 2 <= numFolds <= rows
+ */
+CrossValidationResult CrossValidation::KFold(int numFolds, unsigned int seed) const {
+    if (numFolds < 2 || numFolds > mNumRows) {
+        throw std::invalid_argument("Fold count must be between 2 and the number of rows");
+    }
+    std::mt19937 generator(seed);
+    const std::vector<int> order = StratifiedOrder(generator);
+    std::vector<std::vector<int> > testRows(numFolds);
+    for (int p = 0; p < mNumRows; p++) testRows[p % numFolds].push_back(order[p]);
+    for (int f = 0; f < numFolds; f++) std::sort(testRows[f].begin(), testRows[f].end());
+    return Evaluate(testRows, nullptr, numFolds);
+}
+
+/**
+ * Draws each test set by systematic sampling of a stratified shuffle, so
+ * every stratum contributes in proportion and the test size is exact
+ * @param numRepeats Number of independent splits
+ * @param trainRatio Fraction of rows used for training (rounded down)
+ * @param seed Seed of the first shuffle; later repeats continue the same stream
+ * @return One result per repeat
+ * @throws std::invalid_argument unless numRepeats > 0 and both parts are non-empty
+ */
+CrossValidationResult CrossValidation::RepeatedHoldout(int numRepeats, double trainRatio, unsigned int seed) const {
+    const int trainCount = static_cast<int>(mNumRows * trainRatio);
+    const int testCount = mNumRows - trainCount;
+    if (numRepeats <= 0 || !(trainRatio > 0.0) || trainCount <= 0 || testCount <= 0) {
+        throw std::invalid_argument("Holdout needs a positive repeat count and non-empty train and test sets");
+    }
+    std::mt19937 generator(seed);
+    std::vector<std::vector<int> > testRows(numRepeats);
+    for (int r = 0; r < numRepeats; r++) {
+        const std::vector<int> order = StratifiedOrder(generator);
+        for (int p = 0; p < mNumRows; p++) {
+            if ((static_cast<long long>(p) + 1) * testCount / mNumRows != static_cast<long long>(p) * testCount / mNumRows) {
+                testRows[r].push_back(order[p]);
+            }
+        }
+        std::sort(testRows[r].begin(), testRows[r].end());
+    }
+
+    std::vector<int> allRows(mNumRows);
+    for (int i = 0; i < mNumRows; i++) allRows[i] = i;
+    RegressionAccumulator total(mNumFeatures, mNumTargets);
+    mSource(allRows, total);
+    return Evaluate(testRows, &total, 1);
+}
+
+/**
+ * Accumulates every test set concurrently, then fits every complement
+ * concurrently from the downdated total
+ * @param testRows Test rows of each evaluation, in result order
+ * @param total Accumulator over all rows, or null if the test sets partition the rows
+ * @param foldsPerRepeat Evaluations per repeat, for numbering the results
+ */
+CrossValidationResult CrossValidation::Evaluate(const std::vector<std::vector<int> >& testRows,
+                                                const RegressionAccumulator* total, int foldsPerRepeat) const {
+    const int k = static_cast<int>(testRows.size());
+    ThreadPool& pool = ThreadPool::Global();
+    std::vector<RegressionAccumulator> tests(k, RegressionAccumulator(mNumFeatures, mNumTargets));
+    pool.ParallelFor(0, k, 1, [&](int first, int last) {
+        for (int f = first; f < last; f++) mSource(testRows[f], tests[f]);
+    });
+
+    RegressionAccumulator merged(mNumFeatures, mNumTargets);
+    if (!total) {
+        for (int f = 0; f < k; f++) merged.Merge(tests[f]);
+        total = &merged;
+    }
+
+    CrossValidationResult result;
+    result.folds.resize(k);
+    pool.ParallelFor(0, k, 1, [&](int first, int last) {
+        for (int f = first; f < last; f++) {
+            RegressionAccumulator training = *total;
+            training.Subtract(tests[f]);
+            FoldResult& fold = result.folds[f];
+            fold.repeat = f / foldsPerRepeat;
+            fold.fold = f % foldsPerRepeat;
+            fold.trainRows = static_cast<int>(training.GetNumRows());
+            fold.testRows = static_cast<int>(tests[f].GetNumRows());
+            fold.coefficients = training.Solve();
+            fold.trainRMSE = training.RootMeanSquaredError(fold.coefficients);
+            fold.testRMSE = tests[f].RootMeanSquaredError(fold.coefficients);
+        }
+    });
+    Summarize(result, mNumTargets);
+    return result;
+}
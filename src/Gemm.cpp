@@ -0,0 +1,387 @@
+#include "Gemm.h"
+#include "AlignedMemory.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEMM_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Register tile computed by one micro-kernel call (MR rows x NR columns).
+// Both types use twelve 256-bit accumulators; a float register holds twice
+// as many lanes, so the float tile is twice as wide.
+template <typename T>
+struct GemmTile;
+
+template <>
+struct GemmTile<double> {
+    static const int kMR = 6;
+    static const int kNR = 8;
+};
+
+template <>
+struct GemmTile<float> {
+    static const int kMR = 6;
+    static const int kNR = 16;
+};
+
+// Cache blocking: an MC x KC block of A stays in L2, a KC x NR sliver of B
+// in L1, and a KC x NC panel of B in L3. NC is a multiple of every NR.
+const int kMC = 72;
+const int kKC = 256;
+const int kNC = 4080;
+
+// Below this many multiply-adds, packing costs more than it saves
+const double kSmallProduct = 32.0 * 32.0 * 32.0;
+
+// Below this many multiply-adds, thread dispatch costs more than it saves
+const double kParallelProduct = 128.0 * 128.0 * 128.0;
+
+template <typename T>
+using MicroKernel = void (*)(int kc, const T* a, const T* b, T* c, int ldc);
+
+// Accumulates the packed MR x kc sliver `a` times the packed kc x NR sliver `b` into C
+template <typename T>
+void MicroKernelScalar(int kc, const T* a, const T* b, T* c, int ldc) {
+    const int kMR = GemmTile<T>::kMR;
+    const int kNR = GemmTile<T>::kNR;
+    T acc[kMR][kNR] = {};
+    for (int p = 0; p < kc; p++) {
+        for (int i = 0; i < kMR; i++) {
+            const T ai = a[i];
+            for (int j = 0; j < kNR; j++) {
+                acc[i][j] += ai * b[j];
+            }
+        }
+        a += kMR;
+        b += kNR;
+    }
+    for (int i = 0; i < kMR; i++) {
+        for (int j = 0; j < kNR; j++) {
+            c[static_cast<std::size_t>(i) * ldc + j] += acc[i][j];
+        }
+    }
+}
+
+#ifdef GEMM_HAVE_AVX2_KERNEL
+// 6x8 tile held in twelve ymm accumulators; packed B rows are 64-byte aligned
+__attribute__((target("avx2,fma")))
+void MicroKernelAvx2(int kc, const double* a, const double* b, double* c, int ldc) {
+    const int kMR = GemmTile<double>::kMR;
+    const int kNR = GemmTile<double>::kNR;
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+    __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+
+    for (int p = 0; p < kc; p++) {
+        const __m256d b0 = _mm256_load_pd(b);
+        const __m256d b1 = _mm256_load_pd(b + 4);
+        __m256d ai;
+        ai = _mm256_broadcast_sd(a + 0);
+        c00 = _mm256_fmadd_pd(ai, b0, c00); c01 = _mm256_fmadd_pd(ai, b1, c01);
+        ai = _mm256_broadcast_sd(a + 1);
+        c10 = _mm256_fmadd_pd(ai, b0, c10); c11 = _mm256_fmadd_pd(ai, b1, c11);
+        ai = _mm256_broadcast_sd(a + 2);
+        c20 = _mm256_fmadd_pd(ai, b0, c20); c21 = _mm256_fmadd_pd(ai, b1, c21);
+        ai = _mm256_broadcast_sd(a + 3);
+        c30 = _mm256_fmadd_pd(ai, b0, c30); c31 = _mm256_fmadd_pd(ai, b1, c31);
+        ai = _mm256_broadcast_sd(a + 4);
+        c40 = _mm256_fmadd_pd(ai, b0, c40); c41 = _mm256_fmadd_pd(ai, b1, c41);
+        ai = _mm256_broadcast_sd(a + 5);
+        c50 = _mm256_fmadd_pd(ai, b0, c50); c51 = _mm256_fmadd_pd(ai, b1, c51);
+        a += kMR;
+        b += kNR;
+    }
+
+    double* r;
+    r = c;                  _mm256_storeu_pd(r, _mm256_add_pd(_mm256_loadu_pd(r), c00));
+                            _mm256_storeu_pd(r + 4, _mm256_add_pd(_mm256_loadu_pd(r + 4), c01));
+    r = c + ldc;            _mm256_storeu_pd(r, _mm256_add_pd(_mm256_loadu_pd(r), c10));
+                            _mm256_storeu_pd(r + 4, _mm256_add_pd(_mm256_loadu_pd(r + 4), c11));
+    r = c + 2 * ldc;        _mm256_storeu_pd(r, _mm256_add_pd(_mm256_loadu_pd(r), c20));
+                            _mm256_storeu_pd(r + 4, _mm256_add_pd(_mm256_loadu_pd(r + 4), c21));
+    r = c + 3 * ldc;        _mm256_storeu_pd(r, _mm256_add_pd(_mm256_loadu_pd(r), c30));
+                            _mm256_storeu_pd(r + 4, _mm256_add_pd(_mm256_loadu_pd(r + 4), c31));
+    r = c + 4 * ldc;        _mm256_storeu_pd(r, _mm256_add_pd(_mm256_loadu_pd(r), c40));
+                            _mm256_storeu_pd(r + 4, _mm256_add_pd(_mm256_loadu_pd(r + 4), c41));
+    r = c + 5 * ldc;        _mm256_storeu_pd(r, _mm256_add_pd(_mm256_loadu_pd(r), c50));
+                            _mm256_storeu_pd(r + 4, _mm256_add_pd(_mm256_loadu_pd(r + 4), c51));
+}
+
+// 6x16 float tile, the same register layout with eight lanes per accumulator
+__attribute__((target("avx2,fma")))
+void MicroKernelAvx2(int kc, const float* a, const float* b, float* c, int ldc) {
+    const int kMR = GemmTile<float>::kMR;
+    const int kNR = GemmTile<float>::kNR;
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+    for (int p = 0; p < kc; p++) {
+        const __m256 b0 = _mm256_load_ps(b);
+        const __m256 b1 = _mm256_load_ps(b + 8);
+        __m256 ai;
+        ai = _mm256_broadcast_ss(a + 0);
+        c00 = _mm256_fmadd_ps(ai, b0, c00); c01 = _mm256_fmadd_ps(ai, b1, c01);
+        ai = _mm256_broadcast_ss(a + 1);
+        c10 = _mm256_fmadd_ps(ai, b0, c10); c11 = _mm256_fmadd_ps(ai, b1, c11);
+        ai = _mm256_broadcast_ss(a + 2);
+        c20 = _mm256_fmadd_ps(ai, b0, c20); c21 = _mm256_fmadd_ps(ai, b1, c21);
+        ai = _mm256_broadcast_ss(a + 3);
+        c30 = _mm256_fmadd_ps(ai, b0, c30); c31 = _mm256_fmadd_ps(ai, b1, c31);
+        ai = _mm256_broadcast_ss(a + 4);
+        c40 = _mm256_fmadd_ps(ai, b0, c40); c41 = _mm256_fmadd_ps(ai, b1, c41);
+        ai = _mm256_broadcast_ss(a + 5);
+        c50 = _mm256_fmadd_ps(ai, b0, c50); c51 = _mm256_fmadd_ps(ai, b1, c51);
+        a += kMR;
+        b += kNR;
+    }
+
+    float* r;
+    r = c;                  _mm256_storeu_ps(r, _mm256_add_ps(_mm256_loadu_ps(r), c00));
+                            _mm256_storeu_ps(r + 8, _mm256_add_ps(_mm256_loadu_ps(r + 8), c01));
+    r = c + ldc;            _mm256_storeu_ps(r, _mm256_add_ps(_mm256_loadu_ps(r), c10));
+                            _mm256_storeu_ps(r + 8, _mm256_add_ps(_mm256_loadu_ps(r + 8), c11));
+    r = c + 2 * ldc;        _mm256_storeu_ps(r, _mm256_add_ps(_mm256_loadu_ps(r), c20));
+                            _mm256_storeu_ps(r + 8, _mm256_add_ps(_mm256_loadu_ps(r + 8), c21));
+    r = c + 3 * ldc;        _mm256_storeu_ps(r, _mm256_add_ps(_mm256_loadu_ps(r), c30));
+                            _mm256_storeu_ps(r + 8, _mm256_add_ps(_mm256_loadu_ps(r + 8), c31));
+    r = c + 4 * ldc;        _mm256_storeu_ps(r, _mm256_add_ps(_mm256_loadu_ps(r), c40));
+                            _mm256_storeu_ps(r + 8, _mm256_add_ps(_mm256_loadu_ps(r + 8), c41));
+    r = c + 5 * ldc;        _mm256_storeu_ps(r, _mm256_add_ps(_mm256_loadu_ps(r), c50));
+                            _mm256_storeu_ps(r + 8, _mm256_add_ps(_mm256_loadu_ps(r + 8), c51));
+}
+#endif
+
+template <typename T>
+struct KernelChoice {
+    MicroKernel<T> kernel;
+    const char* name;
+};
+
+bool CpuHasAvx2Fma() {
+#ifdef GEMM_HAVE_AVX2_KERNEL
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+template <typename T>
+KernelChoice<T> SelectKernel() {
+#ifdef GEMM_HAVE_AVX2_KERNEL
+    if (CpuHasAvx2Fma()) {
+        MicroKernel<T> kernel = MicroKernelAvx2;
+        KernelChoice<T> choice = { kernel, "avx2-fma" };
+        return choice;
+    }
+#endif
+    KernelChoice<T> choice = { MicroKernelScalar<T>, "scalar" };
+    return choice;
+}
+
+template <typename T>
+const KernelChoice<T>& Kernel() {
+    static const KernelChoice<T> choice = SelectKernel<T>();
+    return choice;
+}
+
+// Owns an aligned scratch buffer for the packed panels
+template <typename T>
+struct PackBuffer {
+    T* data;
+    explicit PackBuffer(std::size_t count)
+        : data(static_cast<T*>(AllocateAligned(count * sizeof(T)))) {}
+    ~PackBuffer() { FreeAligned(data); }
+};
+
+template <typename T>
+inline T ElementA(bool trans, const T* A, int lda, int i, int p) {
+    return trans ? A[static_cast<std::size_t>(p) * lda + i] : A[static_cast<std::size_t>(i) * lda + p];
+}
+
+template <typename T>
+inline T ElementB(bool trans, const T* B, int ldb, int p, int j) {
+    return trans ? B[static_cast<std::size_t>(j) * ldb + p] : B[static_cast<std::size_t>(p) * ldb + j];
+}
+
+// Packs alpha * op(A)[ic:ic+mc, pc:pc+kc] into MR-row slivers, zero-padding the last one
+template <typename T>
+void PackA(bool trans, const T* A, int lda, int ic, int pc, int mc, int kc,
+           T alpha, T* dst) {
+    const int kMR = GemmTile<T>::kMR;
+    for (int ir = 0; ir < mc; ir += kMR) {
+        const int mr = std::min(kMR, mc - ir);
+        for (int p = 0; p < kc; p++) {
+            for (int i = 0; i < mr; i++) {
+                *dst++ = alpha * ElementA(trans, A, lda, ic + ir + i, pc + p);
+            }
+            for (int i = mr; i < kMR; i++) {
+                *dst++ = T(0);
+            }
+        }
+    }
+}
+
+// Packs op(B)[pc:pc+kc, jc:jc+nc] into NR-column slivers, zero-padding the last one
+template <typename T>
+void PackB(bool trans, const T* B, int ldb, int pc, int jc, int kc, int nc, T* dst) {
+    const int kNR = GemmTile<T>::kNR;
+    for (int jr = 0; jr < nc; jr += kNR) {
+        const int nr = std::min(kNR, nc - jr);
+        for (int p = 0; p < kc; p++) {
+            if (!trans && nr == kNR) {
+                const T* src = B + static_cast<std::size_t>(pc + p) * ldb + jc + jr;
+                for (int j = 0; j < kNR; j++) dst[j] = src[j];
+                dst += kNR;
+                continue;
+            }
+            for (int j = 0; j < nr; j++) {
+                *dst++ = ElementB(trans, B, ldb, pc + p, jc + jr + j);
+            }
+            for (int j = nr; j < kNR; j++) {
+                *dst++ = T(0);
+            }
+        }
+    }
+}
+
+// Runs the micro-kernel over every MR x NR tile of an mc x nc block of C
+template <typename T>
+void MacroKernel(int mc, int nc, int kc, const T* packedA, const T* packedB,
+                 T* C, int ldc, MicroKernel<T> kernel) {
+    const int kMR = GemmTile<T>::kMR;
+    const int kNR = GemmTile<T>::kNR;
+    T edge[kMR * kNR];
+    for (int jr = 0; jr < nc; jr += kNR) {
+        const int nr = std::min(kNR, nc - jr);
+        const T* b = packedB + static_cast<std::size_t>(jr) * kc;
+        for (int ir = 0; ir < mc; ir += kMR) {
+            const int mr = std::min(kMR, mc - ir);
+            const T* a = packedA + static_cast<std::size_t>(ir) * kc;
+            T* c = C + static_cast<std::size_t>(ir) * ldc + jr;
+            if (mr == kMR && nr == kNR) {
+                kernel(kc, a, b, c, ldc);
+                continue;
+            }
+            // Partial tile: compute into scratch, then add the valid part
+            std::fill(edge, edge + kMR * kNR, T(0));
+            kernel(kc, a, b, edge, kNR);
+            for (int i = 0; i < mr; i++) {
+                for (int j = 0; j < nr; j++) {
+                    c[static_cast<std::size_t>(i) * ldc + j] += edge[i * kNR + j];
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+void GemmSmall(bool transA, bool transB, int m, int n, int k, T alpha,
+               const T* A, int lda, const T* B, int ldb, T* C, int ldc) {
+    for (int i = 0; i < m; i++) {
+        T* rowC = C + static_cast<std::size_t>(i) * ldc;
+        for (int p = 0; p < k; p++) {
+            const T a = alpha * ElementA(transA, A, lda, i, p);
+            if (!transB) {
+                const T* rowB = B + static_cast<std::size_t>(p) * ldb;
+                for (int j = 0; j < n; j++) rowC[j] += a * rowB[j];
+            } else {
+                for (int j = 0; j < n; j++) rowC[j] += a * B[static_cast<std::size_t>(j) * ldb + p];
+            }
+        }
+    }
+}
+
+template <typename T>
+void GemmImpl(bool transA, bool transB, int m, int n, int k,
+              T alpha, const T* A, int lda,
+              const T* B, int ldb,
+              T beta, T* C, int ldc) {
+    const int kMR = GemmTile<T>::kMR;
+    const int kNR = GemmTile<T>::kNR;
+    if (m <= 0 || n <= 0) return;
+
+    // Apply beta up front so the kernels only ever accumulate into C
+    if (beta != T(1)) {
+        for (int i = 0; i < m; i++) {
+            T* rowC = C + static_cast<std::size_t>(i) * ldc;
+            if (beta == T(0)) {
+                std::fill(rowC, rowC + n, T(0));
+            } else {
+                for (int j = 0; j < n; j++) rowC[j] *= beta;
+            }
+        }
+    }
+    if (k <= 0 || alpha == T(0)) return;
+
+    if (static_cast<double>(m) * n * k < kSmallProduct) {
+        GemmSmall(transA, transB, m, n, k, alpha, A, lda, B, ldb, C, ldc);
+        return;
+    }
+
+    const MicroKernel<T> kernel = Kernel<T>().kernel;
+    const int ncMax = std::min(kNC, ((n + kNR - 1) / kNR) * kNR);
+    const int kcMax = std::min(kKC, k);
+    const int mcMax = std::min(kMC, ((m + kMR - 1) / kMR) * kMR);
+    PackBuffer<T> packedB(static_cast<std::size_t>(kcMax) * ncMax);
+
+    // The packed B panel is shared; each task packs its own MC x KC blocks of A
+    ThreadPool& pool = ThreadPool::Global();
+    const bool parallel = static_cast<double>(m) * n * k >= kParallelProduct;
+    const int numBlocksM = (m + kMC - 1) / kMC;
+
+    for (int jc = 0; jc < n; jc += kNC) {
+        const int nc = std::min(kNC, n - jc);
+        const int numSlivers = (nc + kNR - 1) / kNR;
+        for (int pc = 0; pc < k; pc += kKC) {
+            const int kc = std::min(kKC, k - pc);
+            pool.ParallelFor(0, numSlivers, parallel ? 16 : numSlivers, [&](int first, int last) {
+                const int col = first * kNR;
+                PackB(transB, B, ldb, pc, jc + col, kc, std::min(nc, last * kNR) - col,
+                      packedB.data + static_cast<std::size_t>(col) * kc);
+            });
+            pool.ParallelFor(0, numBlocksM, parallel ? 1 : numBlocksM, [&](int first, int last) {
+                PackBuffer<T> packedA(static_cast<std::size_t>(kcMax) * mcMax);
+                for (int block = first; block < last; block++) {
+                    const int ic = block * kMC;
+                    const int mc = std::min(kMC, m - ic);
+                    PackA(transA, A, lda, ic, pc, mc, kc, alpha, packedA.data);
+                    MacroKernel(mc, nc, kc, packedA.data, packedB.data,
+                                C + static_cast<std::size_t>(ic) * ldc + jc, ldc, kernel);
+                }
+            });
+        }
+    }
+}
+
+} // namespace
+
+void Gemm(bool transA, bool transB, int m, int n, int k,
+          double alpha, const double* A, int lda,
+          const double* B, int ldb,
+          double beta, double* C, int ldc) {
+    GemmImpl(transA, transB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+void Gemm(bool transA, bool transB, int m, int n, int k,
+          float alpha, const float* A, int lda,
+          const float* B, int ldb,
+          float beta, float* C, int ldc) {
+    GemmImpl(transA, transB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+const char* GemmKernelName() {
+    return Kernel<double>().name;
+}
@@ -0,0 +1,735 @@
+#include "HardwareDataset.h"
+#include "AlignedMemory.h"
+#include "ThreadPool.h"
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+// Bytes read from the file per batch; lines may straddle two batches
+const std::size_t kBatchSize = 64 << 20;
+
+// Each batch is cut into about this many chunks per thread (for load
+// balance), but never into chunks smaller than kMinChunkSize
+const std::size_t kChunksPerThread = 4;
+const std::size_t kMinChunkSize = 1 << 20;
+
+const char* const kFieldNames[kNumHardwareFields] = {
+    "MYCT", "MMIN", "MMAX", "CACH", "CHMIN", "CHMAX", "PRP", "ERP"
+};
+
+bool IsBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Advances past the next comma (or to end) and returns the field in [begin, fieldEnd)
+const char* NextField(const char*& cursor, const char* end) {
+    const char* comma = static_cast<const char*>(std::memchr(cursor, ',', end - cursor));
+    const char* fieldEnd = comma ? comma : end;
+    cursor = comma ? comma + 1 : end;
+    return fieldEnd;
+}
+
+/**
+ * Parses a base-10 integer spanning the whole field, allowing surrounding
+ * blanks and a sign; unlike std::stoi, trailing characters ("12abc") are an
+ * error. Accumulates in long long so overflow is detected without reading
+ * past the field.
+ */
+int ParseInt(const char* begin, const char* end, const char* fieldName) {
+    while (begin < end && IsBlank(*begin)) begin++;
+    while (end > begin && IsBlank(end[-1])) end--;
+    bool negative = false;
+    if (begin < end && (*begin == '-' || *begin == '+')) {
+        negative = *begin == '-';
+        begin++;
+    }
+    if (begin == end) {
+        throw std::runtime_error(std::string("Error reading ") + fieldName);
+    }
+    long long value = 0;
+    for (const char* p = begin; p < end; p++) {
+        const unsigned digit = static_cast<unsigned>(*p - '0');
+        if (digit > 9) {
+            throw std::runtime_error(std::string("Invalid integer for ") + fieldName);
+        }
+        value = value * 10 + digit;
+        if (value > INT_MAX) {
+            throw std::runtime_error(std::string("Value out of range for ") + fieldName);
+        }
+    }
+    return static_cast<int>(negative ? -value : value);
+}
+
+// Binary cache layout: this header, then 64-byte aligned sections for the
+// eight columns, the vendor ids, the model name offsets and bytes, and the
+// vendor dictionary (offsets and bytes). All offsets are from the file start.
+const char kCacheMagic[8] = "TPHWCOL";
+const std::uint32_t kCacheVersion = 2;
+const std::uint32_t kByteOrderMark = 0x01020304;   // Rejects caches written with the other byte order
+
+struct CacheHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrderMark;
+    std::uint64_t sourceSize;            // Stamp of the CSV the cache was built from
+    std::int64_t sourceModifiedTime;     // Nanoseconds since the epoch where the platform has them
+    std::uint64_t fileSize;              // Detects truncated files
+    std::int32_t numRows;
+    std::int32_t numVendors;
+    std::uint64_t columnOffsets[kNumHardwareFields];
+    std::uint64_t vendorIdOffset;
+    std::uint64_t modelOffsetsOffset;    // numRows + 1 uint64 offsets into the model bytes
+    std::uint64_t modelDataOffset;
+    std::uint64_t vendorOffsetsOffset;   // numVendors + 1 uint64 offsets into the vendor bytes
+    std::uint64_t vendorDataOffset;
+};
+
+bool GetSourceStamp(const std::string& filename, std::uint64_t& size, std::int64_t& modifiedTime) {
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0) return false;
+    size = static_cast<std::uint64_t>(info.st_size);
+    // Whole seconds miss a rewrite within the same second that keeps the size
+#if defined(__APPLE__)
+    const long nanoseconds = info.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+    const long nanoseconds = 0;
+#else
+    const long nanoseconds = info.st_mtim.tv_nsec;
+#endif
+    modifiedTime = static_cast<std::int64_t>(info.st_mtime) * 1000000000 + nanoseconds;
+    return true;
+}
+
+// Unique per process and call, so concurrent writers never share a temp file
+std::string TempFilename(const std::string& filename) {
+    static std::atomic<unsigned> counter(0);
+#ifdef _WIN32
+    const long pid = _getpid();
+#else
+    const long pid = static_cast<long>(getpid());
+#endif
+    return filename + "." + std::to_string(pid) + "-" + std::to_string(counter++) + ".tmp";
+}
+
+// Pads to the next aligned position, writes the section and returns its offset
+std::uint64_t AppendSection(std::FILE* file, std::uint64_t& position, const void* data, std::size_t bytes) {
+    static const char zeros[kMemoryAlignment] = {};
+    const std::size_t padding = static_cast<std::size_t>((kMemoryAlignment - position % kMemoryAlignment) % kMemoryAlignment);
+    std::fwrite(zeros, 1, padding, file);
+    const std::uint64_t offset = position + padding;
+    std::fwrite(data, 1, bytes, file);
+    position = offset + bytes;
+    return offset;
+}
+
+bool SectionFits(std::uint64_t offset, std::uint64_t bytes, std::uint64_t fileSize) {
+    return offset % kMemoryAlignment == 0 && offset <= fileSize && bytes <= fileSize - offset;
+}
+
+// Offsets must start at 0, never decrease and stay inside their byte section
+bool OffsetsValid(const std::uint64_t* offsets, int count, std::uint64_t dataOffset, std::uint64_t fileSize) {
+    if (offsets[0] != 0) return false;
+    for (int i = 0; i < count; i++) {
+        if (offsets[i + 1] < offsets[i]) return false;
+    }
+    return SectionFits(dataOffset, offsets[count], fileSize);
+}
+}
+
+const char* HardwareFieldName(HardwareField field) {
+    if (field < 0 || field >= kNumHardwareFields) {
+        throw std::out_of_range("Unknown hardware field");
+    }
+    return kFieldNames[field];
+}
+
+double ParseStats::MegabytesPerSecond() const {
+    return seconds > 0.0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+HardwareDataset::HardwareDataset() : mNumRows(0), mModelNameOffsets(1, 0) {
+    BindOwnedStorage();
+}
+
+// A mapped copy shares the mapping; an owned copy rebinds to its own vectors
+HardwareDataset::HardwareDataset(const HardwareDataset& other)
+    : mNumRows(other.mNumRows), mVendorIds(other.mVendorIds), mVendorNames(other.mVendorNames),
+      mVendorLookup(other.mVendorLookup), mModelNameData(other.mModelNameData),
+      mModelNameOffsets(other.mModelNameOffsets), mpMapping(other.mpMapping),
+      mVendorIdView(other.mVendorIdView), mModelNameView(other.mModelNameView),
+      mModelOffsetView(other.mModelOffsetView) {
+    for (int f = 0; f < kNumHardwareFields; f++) {
+        mColumns[f] = other.mColumns[f];
+        mColumnViews[f] = other.mColumnViews[f];
+    }
+    if (!mpMapping) BindOwnedStorage();
+}
+
+HardwareDataset& HardwareDataset::operator=(const HardwareDataset& other) {
+    if (this != &other) {
+        HardwareDataset copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+void HardwareDataset::BindOwnedStorage() {
+    for (int f = 0; f < kNumHardwareFields; f++) mColumnViews[f] = mColumns[f].data();
+    mVendorIdView = mVendorIds.data();
+    mModelNameView = mModelNameData.data();
+    mModelOffsetView = mModelNameOffsets.data();
+}
+
+struct HardwareDataset::LineError {
+    long line;            // Line number within the chunk, 0-based
+    std::string text;
+    std::string message;
+};
+
+struct HardwareDataset::ChunkResult {
+    HardwareDataset rows;
+    HardwareDataset* target;   // Where rows are appended: &rows, or the output for the first chunk
+    std::vector<LineError> errors;
+    long lines;                // Newline-terminated lines, including empty ones
+    long nonEmptyLines;
+    long accepted;
+
+    ChunkResult() : target(&rows), lines(0), nonEmptyLines(0), accepted(0) {}
+};
+
+// Parses the complete lines in [begin, end); the last line may lack its newline
+void HardwareDataset::ParseChunk(const char* begin, const char* end, ChunkResult& result) {
+    const char* cursor = begin;
+    while (cursor < end) {
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        const char* lineEnd = newline ? newline : end;
+        const char* contentEnd = lineEnd;
+        if (contentEnd > cursor && contentEnd[-1] == '\r') contentEnd--;
+        // Blank lines are skipped silently rather than reported as invalid
+        if (contentEnd > cursor) {
+            result.nonEmptyLines++;
+            try {
+                result.target->AppendCsvLine(cursor, contentEnd);
+                result.accepted++;
+            } catch (const std::exception& e) {
+                LineError error = { result.lines, std::string(cursor, contentEnd), e.what() };
+                result.errors.push_back(error);
+            }
+        }
+        result.lines++;
+        cursor = newline ? newline + 1 : end;
+    }
+}
+
+/**
+ * Reads the file in batches and parses each batch in parallel chunks cut
+ * at newlines; only the model name bytes and new vendor names are copied.
+ * What stays serial per batch is cutting it, reporting errors and merging
+ * the vendor dictionaries, all small next to parsing, so the speedup is
+ * bounded by how fast the file can be read. No multi-thread speedup is
+ * quoted: the only machine this was measured on has a single core, where a
+ * 214 MB file took about 1.5 s before and after double-buffering.
+ * @param filename Path of the CSV file
+ * @param stats Receives size, row counts and elapsed time if not null
+ * @return Loaded data set
+ * @throws std::runtime_error if the file cannot be opened or has no valid rows
+ */
+HardwareDataset HardwareDataset::ReadCsv(const std::string& filename, ParseStats* stats) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::FILE* file = std::fopen(filename.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    // Size the buffer to the file when it is smaller than one batch
+    std::size_t capacity = kBatchSize;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        const long size = std::ftell(file);
+        if (size >= 0 && static_cast<unsigned long>(size) < kBatchSize) {
+            capacity = std::max<std::size_t>(static_cast<std::size_t>(size) + 1, 4096);
+        }
+    }
+    std::rewind(file);
+
+    ThreadPool& pool = ThreadPool::Global();
+    HardwareDataset data;
+    ParseStats local;
+    // Batch k + 1 is read into one buffer while batch k is parsed from the
+    // other. The reader first moves the unfinished line at the end of batch
+    // k to the front of its buffer, and grows the buffer if that line fills
+    // it.
+    std::vector<char> buffers[2] = { std::vector<char>(capacity), std::vector<char>(capacity) };
+    auto fill = [file](std::vector<char>& buffer, const char* tail, std::size_t tailSize, std::size_t& got) {
+        while (tailSize >= buffer.size()) buffer.resize(2 * buffer.size());
+        if (tailSize > 0) std::memcpy(buffer.data(), tail, tailSize);
+        got = std::fread(buffer.data() + tailSize, 1, buffer.size() - tailSize, file);
+        return tailSize + got;
+    };
+
+    int current = 0;
+    std::size_t got = 0;
+    std::size_t size = fill(buffers[0], nullptr, 0, got);
+    long linesBefore = 0;      // Lines in earlier batches, for error messages
+    for (;;) {
+        local.bytes += got;
+        const bool atEnd = got == 0;
+        const char* begin = buffers[current].data();
+        const char* end = begin + size;
+
+        // Parse up to the last newline; the tail waits for the next read
+        const char* parseEnd = end;
+        if (!atEnd) {
+            while (parseEnd > begin && parseEnd[-1] != '\n') parseEnd--;
+        }
+        std::size_t nextGot = 0;
+        std::future<std::size_t> next;
+        if (!atEnd) {
+            next = std::async(std::launch::async, fill, std::ref(buffers[1 - current]), parseEnd,
+                              static_cast<std::size_t>(end - parseEnd), std::ref(nextGot));
+        }
+
+        if (parseEnd > begin) {
+            // Cut the batch into roughly equal chunks, each ending after a newline
+            const std::size_t batchBytes = parseEnd - begin;
+            const std::size_t maxChunks = pool.GetNumThreads() > 1 ? pool.GetNumThreads() * kChunksPerThread : 1;
+            const std::size_t numChunks = std::max<std::size_t>(1, std::min(maxChunks, batchBytes / kMinChunkSize));
+            std::vector<const char*> cuts(1, begin);
+            for (std::size_t c = 1; c < numChunks; c++) {
+                const char* target = begin + batchBytes * c / numChunks;
+                if (target < cuts.back()) continue;
+                const char* newline = static_cast<const char*>(std::memchr(target, '\n', parseEnd - target));
+                if (!newline || newline + 1 >= parseEnd) break;
+                cuts.push_back(newline + 1);
+            }
+            cuts.push_back(parseEnd);
+
+            const int chunks = static_cast<int>(cuts.size()) - 1;
+            // The first chunk appends to the output directly; only the others are merged
+            std::vector<ChunkResult> results(chunks);
+            results[0].target = &data;
+            pool.ParallelFor(0, chunks, 1, [&](int first, int last) {
+                for (int c = first; c < last; c++) ParseChunk(cuts[c], cuts[c + 1], results[c]);
+            });
+
+            // Report and merge in file order so rows, vendor ids and messages match a serial read
+            std::vector<const HardwareDataset*> parts;
+            for (int c = 0; c < chunks; c++) {
+                const ChunkResult& result = results[c];
+                for (std::size_t e = 0; e < result.errors.size(); e++) {
+                    const LineError& error = result.errors[e];
+                    std::cerr << "Error processing line " << linesBefore + error.line + 1 << ": " << error.text << "\n";
+                    std::cerr << "Error details: " << error.message << "\n";
+                }
+                if (c > 0) parts.push_back(&result.rows);   // Invalid lines were skipped instead of failing completely
+                local.lines += result.nonEmptyLines;
+                local.rowsAccepted += result.accepted;
+                local.rowsRejected += static_cast<long>(result.errors.size());
+                linesBefore += result.lines;
+            }
+            data.AppendRows(parts);
+            local.chunks += chunks;
+        }
+
+        if (atEnd) break;
+        size = next.get();
+        got = nextGot;
+        current = 1 - current;
+    }
+    const bool readError = std::ferror(file) != 0;
+    std::fclose(file);
+    if (readError) {
+        throw std::runtime_error("Error reading file: " + filename);
+    }
+
+    if (data.mNumRows == 0) {
+        throw std::runtime_error("No valid data read from file");
+    }
+    data.BindOwnedStorage();
+    local.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (stats) *stats = local;
+    return data;
+}
+
+void HardwareDataset::WriteCache(const std::string& cacheFilename, const std::string& sourceFilename) const {
+    std::uint64_t sourceSize = 0;
+    std::int64_t sourceModifiedTime = 0;
+    if (!GetSourceStamp(sourceFilename, sourceSize, sourceModifiedTime)) {
+        throw std::runtime_error("Could not access file: " + sourceFilename);
+    }
+    WriteCacheFile(cacheFilename, sourceSize, sourceModifiedTime);
+}
+
+/**
+ * Writes the sections to a temporary file and renames it over the cache,
+ * so a process that still maps the old cache keeps a consistent view. The
+ * header is written last; a partially written file has no valid magic.
+ * @throws std::runtime_error if the file cannot be written or renamed
+ */
+void HardwareDataset::WriteCacheFile(const std::string& cacheFilename, std::uint64_t sourceSize,
+                                     std::int64_t sourceModifiedTime) const {
+    const std::string tempFilename = TempFilename(cacheFilename);
+    std::FILE* file = std::fopen(tempFilename.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Could not create file: " + tempFilename);
+    }
+
+    std::vector<std::uint64_t> vendorOffsets(1, 0);
+    std::string vendorData;
+    for (std::size_t v = 0; v < mVendorNames.size(); v++) {
+        vendorData += mVendorNames[v];
+        vendorOffsets.push_back(vendorData.size());
+    }
+
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::fwrite(&header, sizeof(header), 1, file);   // Placeholder until the offsets are known
+    std::uint64_t position = sizeof(header);
+    const std::size_t columnBytes = static_cast<std::size_t>(mNumRows) * sizeof(int);
+    for (int f = 0; f < kNumHardwareFields; f++) {
+        header.columnOffsets[f] = AppendSection(file, position, mColumnViews[f], columnBytes);
+    }
+    header.vendorIdOffset = AppendSection(file, position, mVendorIdView, columnBytes);
+    header.modelOffsetsOffset = AppendSection(file, position, mModelOffsetView,
+                                              (mNumRows + 1) * sizeof(std::uint64_t));
+    header.modelDataOffset = AppendSection(file, position, mModelNameView,
+                                           static_cast<std::size_t>(mModelOffsetView[mNumRows]));
+    header.vendorOffsetsOffset = AppendSection(file, position, vendorOffsets.data(),
+                                               vendorOffsets.size() * sizeof(std::uint64_t));
+    header.vendorDataOffset = AppendSection(file, position, vendorData.data(), vendorData.size());
+
+    std::memcpy(header.magic, kCacheMagic, sizeof(header.magic));
+    header.version = kCacheVersion;
+    header.byteOrderMark = kByteOrderMark;
+    header.sourceSize = sourceSize;
+    header.sourceModifiedTime = sourceModifiedTime;
+    header.fileSize = position;
+    header.numRows = mNumRows;
+    header.numVendors = static_cast<std::int32_t>(mVendorNames.size());
+    std::rewind(file);
+    std::fwrite(&header, sizeof(header), 1, file);
+
+    const bool writeError = std::ferror(file) != 0;
+    if (std::fclose(file) != 0 || writeError) {
+        std::remove(tempFilename.c_str());
+        throw std::runtime_error("Error writing file: " + tempFilename);
+    }
+    // Windows does not rename over an existing file
+    if (std::rename(tempFilename.c_str(), cacheFilename.c_str()) != 0 &&
+        (std::remove(cacheFilename.c_str()) != 0 ||
+         std::rename(tempFilename.c_str(), cacheFilename.c_str()) != 0)) {
+        std::remove(tempFilename.c_str());
+        throw std::runtime_error("Could not replace file: " + cacheFilename);
+    }
+}
+
+/**
+ * Maps the cache and points the column views into it. Only the layout and
+ * the offset and vendor id arrays are checked (one pass over two columns);
+ * the values themselves are used as stored.
+ * @param cacheFilename Path of a file written by WriteCache
+ * @return Data set reading from the mapping
+ * @throws std::runtime_error if the file cannot be mapped or is not a valid cache
+ */
+HardwareDataset HardwareDataset::MapCache(const std::string& cacheFilename) {
+    std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>(cacheFilename);
+    const char* base = mapping->GetData();
+    const std::uint64_t fileSize = mapping->GetSize();
+    const std::string corrupt = "Invalid hardware cache: " + cacheFilename;
+    if (fileSize < sizeof(CacheHeader)) {
+        throw std::runtime_error(corrupt);
+    }
+    const CacheHeader& header = *reinterpret_cast<const CacheHeader*>(base);
+    if (std::memcmp(header.magic, kCacheMagic, sizeof(header.magic)) != 0 ||
+        header.version != kCacheVersion || header.byteOrderMark != kByteOrderMark ||
+        header.fileSize != fileSize || header.numRows < 0 || header.numVendors < 0) {
+        throw std::runtime_error(corrupt);
+    }
+
+    const int numRows = header.numRows;
+    const int numVendors = header.numVendors;
+    const std::uint64_t columnBytes = static_cast<std::uint64_t>(numRows) * sizeof(int);
+    bool valid = SectionFits(header.vendorIdOffset, columnBytes, fileSize) &&
+                 SectionFits(header.modelOffsetsOffset, (numRows + 1ULL) * sizeof(std::uint64_t), fileSize) &&
+                 SectionFits(header.vendorOffsetsOffset, (numVendors + 1ULL) * sizeof(std::uint64_t), fileSize);
+    for (int f = 0; f < kNumHardwareFields; f++) {
+        valid = valid && SectionFits(header.columnOffsets[f], columnBytes, fileSize);
+    }
+    if (!valid) {
+        throw std::runtime_error(corrupt);
+    }
+    const std::uint64_t* modelOffsets = reinterpret_cast<const std::uint64_t*>(base + header.modelOffsetsOffset);
+    const std::uint64_t* vendorOffsets = reinterpret_cast<const std::uint64_t*>(base + header.vendorOffsetsOffset);
+    const int* vendorIds = reinterpret_cast<const int*>(base + header.vendorIdOffset);
+    if (!OffsetsValid(modelOffsets, numRows, header.modelDataOffset, fileSize) ||
+        !OffsetsValid(vendorOffsets, numVendors, header.vendorDataOffset, fileSize)) {
+        throw std::runtime_error(corrupt);
+    }
+    for (int r = 0; r < numRows; r++) {
+        if (vendorIds[r] < 0 || vendorIds[r] >= numVendors) {
+            throw std::runtime_error(corrupt);
+        }
+    }
+
+    HardwareDataset data;
+    data.mNumRows = numRows;
+    const char* vendorData = base + header.vendorDataOffset;
+    for (int v = 0; v < numVendors; v++) {
+        const std::string name(vendorData + vendorOffsets[v], vendorData + vendorOffsets[v + 1]);
+        data.mVendorLookup[name] = v;
+        data.mVendorNames.push_back(name);
+    }
+    for (int f = 0; f < kNumHardwareFields; f++) {
+        data.mColumnViews[f] = reinterpret_cast<const int*>(base + header.columnOffsets[f]);
+    }
+    data.mVendorIdView = vendorIds;
+    data.mModelNameView = base + header.modelDataOffset;
+    data.mModelOffsetView = modelOffsets;
+    data.mpMapping = mapping;
+    return data;
+}
+
+bool HardwareDataset::IsCacheCurrent(const std::string& cacheFilename, const std::string& sourceFilename) {
+    std::uint64_t sourceSize = 0;
+    std::int64_t sourceModifiedTime = 0;
+    if (!GetSourceStamp(sourceFilename, sourceSize, sourceModifiedTime)) return false;
+    std::FILE* file = std::fopen(cacheFilename.c_str(), "rb");
+    if (!file) return false;
+    CacheHeader header;
+    const bool read = std::fread(&header, sizeof(header), 1, file) == 1;
+    std::fclose(file);
+    return read && std::memcmp(header.magic, kCacheMagic, sizeof(header.magic)) == 0 &&
+           header.version == kCacheVersion && header.byteOrderMark == kByteOrderMark &&
+           header.sourceSize == sourceSize && header.sourceModifiedTime == sourceModifiedTime;
+}
+
+/**
+ * Maps the cache when it matches the CSV, otherwise parses the CSV and
+ * writes a fresh cache for the next run. The source is stamped before it
+ * is parsed, so an edit made during the parse leaves the cache stale.
+ * @param csvFilename Path of the CSV file
+ * @param cacheFilename Path of the binary cache
+ * @param stats Receives the load statistics if not null; fromCache tells which path was taken
+ * @return Loaded data set
+ * @throws std::runtime_error as ReadCsv
+ */
+HardwareDataset HardwareDataset::LoadCached(const std::string& csvFilename, const std::string& cacheFilename,
+                                            ParseStats* stats) {
+    if (IsCacheCurrent(cacheFilename, csvFilename)) {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        try {
+            HardwareDataset data = MapCache(cacheFilename);
+            if (stats) {
+                *stats = ParseStats();
+                stats->bytes = data.mpMapping->GetSize();
+                stats->lines = data.mNumRows;
+                stats->rowsAccepted = data.mNumRows;
+                stats->fromCache = true;
+                stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+            return data;
+        } catch (const std::runtime_error&) {
+            // Unreadable cache: fall through and rebuild it
+        }
+    }
+
+    std::uint64_t sourceSize = 0;
+    std::int64_t sourceModifiedTime = 0;
+    const bool stamped = GetSourceStamp(csvFilename, sourceSize, sourceModifiedTime);
+    HardwareDataset data = ReadCsv(csvFilename, stats);
+    if (stamped) {
+        try {
+            data.WriteCacheFile(cacheFilename, sourceSize, sourceModifiedTime);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Warning: " << e.what() << "\n";
+        }
+    }
+    return data;
+}
+
+bool HardwareDataset::IsMapped() const {
+    return static_cast<bool>(mpMapping);
+}
+
+/**
+ * Merges the vendor dictionaries serially, in order, then copies the parts'
+ * columns, remapped vendor ids and model names to their final positions in
+ * parallel
+ */
+void HardwareDataset::AppendRows(const std::vector<const HardwareDataset*>& parts) {
+    const int numParts = static_cast<int>(parts.size());
+    std::vector<std::vector<int> > vendorMaps(numParts);
+    std::vector<int> rowBase(numParts + 1, mNumRows);
+    std::vector<std::size_t> byteBase(numParts + 1, mModelNameData.size());
+    for (int p = 0; p < numParts; p++) {
+        const HardwareDataset& part = *parts[p];
+        for (std::size_t v = 0; v < part.mVendorNames.size(); v++) {
+            const std::string& name = part.mVendorNames[v];
+            vendorMaps[p].push_back(InternVendor(name.data(), name.data() + name.size()));
+        }
+        rowBase[p + 1] = rowBase[p] + part.mNumRows;
+        byteBase[p + 1] = byteBase[p] + part.mModelNameData.size();
+    }
+    const int numRows = rowBase[numParts];
+    for (int f = 0; f < kNumHardwareFields; f++) mColumns[f].resize(numRows);
+    mVendorIds.resize(numRows);
+    mModelNameData.resize(byteBase[numParts]);
+    mModelNameOffsets.resize(static_cast<std::size_t>(numRows) + 1);
+
+    ThreadPool::Global().ParallelFor(0, numParts, 1, [&](int first, int last) {
+        for (int p = first; p < last; p++) {
+            const HardwareDataset& part = *parts[p];
+            const int base = rowBase[p];
+            for (int f = 0; f < kNumHardwareFields; f++) {
+                std::copy(part.mColumns[f].begin(), part.mColumns[f].end(), mColumns[f].begin() + base);
+            }
+            for (int r = 0; r < part.mNumRows; r++) mVendorIds[base + r] = vendorMaps[p][part.mVendorIds[r]];
+            std::copy(part.mModelNameData.begin(), part.mModelNameData.end(), mModelNameData.begin() + byteBase[p]);
+            for (int r = 1; r <= part.mNumRows; r++) {
+                mModelNameOffsets[base + r] = byteBase[p] + part.mModelNameOffsets[r];
+            }
+        }
+    });
+    mNumRows = numRows;
+}
+
+// All fields are parsed and validated before anything is appended, so a
+// rejected line leaves the columns untouched
+void HardwareDataset::AppendCsvLine(const char* begin, const char* end) {
+    const char* cursor = begin;
+    const char* vendorBegin = cursor;
+    const char* vendorEnd = NextField(cursor, end);
+    const char* modelBegin = cursor;
+    const char* modelEnd = NextField(cursor, end);
+    if (vendorEnd == end || modelEnd == end) {
+        throw std::runtime_error("Error reading vendor or model name");
+    }
+
+    int values[kNumHardwareFields];
+    for (int f = 0; f < kNumHardwareFields; f++) {
+        const char* fieldBegin = cursor;
+        const char* fieldEnd = NextField(cursor, end);
+        values[f] = ParseInt(fieldBegin, fieldEnd, kFieldNames[f]);
+        if (values[f] < 0) {
+            throw std::runtime_error(std::string("Negative value not allowed for ") + kFieldNames[f]);
+        }
+        if (f == kMMAX && values[kMMAX] < values[kMMIN]) {
+            throw std::runtime_error("MMAX cannot be less than MMIN");
+        }
+        if (f == kCHMAX && values[kCHMAX] < values[kCHMIN]) {
+            throw std::runtime_error("CHMAX cannot be less than CHMIN");
+        }
+    }
+
+    for (int f = 0; f < kNumHardwareFields; f++) mColumns[f].push_back(values[f]);
+    mVendorIds.push_back(InternVendor(vendorBegin, vendorEnd));
+    mModelNameData.insert(mModelNameData.end(), modelBegin, modelEnd);
+    mModelNameOffsets.push_back(mModelNameData.size());
+    mNumRows++;
+}
+
+// Consecutive rows usually share a vendor, so the previous id is tried before the map
+int HardwareDataset::InternVendor(const char* begin, const char* end) {
+    const std::size_t length = end - begin;
+    if (!mVendorIds.empty()) {
+        const std::string& last = mVendorNames[mVendorIds.back()];
+        if (last.size() == length && std::memcmp(last.data(), begin, length) == 0) {
+            return mVendorIds.back();
+        }
+    }
+    std::string name(begin, end);
+    std::unordered_map<std::string, int>::const_iterator it = mVendorLookup.find(name);
+    if (it != mVendorLookup.end()) return it->second;
+    const int id = static_cast<int>(mVendorNames.size());
+    mVendorLookup[name] = id;
+    mVendorNames.push_back(name);
+    return id;
+}
+
+int HardwareDataset::GetNumRows() const { return mNumRows; }
+
+const int* HardwareDataset::GetColumn(HardwareField field) const {
+    if (field < 0 || field >= kNumHardwareFields) {
+        throw std::out_of_range("Unknown hardware field");
+    }
+    return mColumnViews[field];
+}
+
+int HardwareDataset::GetValue(int row, HardwareField field) const {
+    if (row < 0 || row >= mNumRows) {
+        throw std::out_of_range("Row index out of range");
+    }
+    return GetColumn(field)[row];
+}
+
+int HardwareDataset::GetVendorId(int row) const {
+    if (row < 0 || row >= mNumRows) {
+        throw std::out_of_range("Row index out of range");
+    }
+    return mVendorIdView[row];
+}
+
+const std::string& HardwareDataset::GetVendorName(int row) const {
+    return mVendorNames[GetVendorId(row)];
+}
+
+const std::vector<std::string>& HardwareDataset::GetVendorNames() const {
+    return mVendorNames;
+}
+
+std::string HardwareDataset::GetModelName(int row) const {
+    if (row < 0 || row >= mNumRows) {
+        throw std::out_of_range("Row index out of range");
+    }
+    return std::string(mModelNameView + mModelOffsetView[row], mModelNameView + mModelOffsetView[row + 1]);
+}
+
+/**
+ * Gathers the six hardware features of the selected rows
+ * @param rows 0-based row indices, in the order wanted
+ * @return rows.size() x 6 design matrix
+ */
+Matrix HardwareDataset::CreateDesignMatrix(const std::vector<int>& rows) const {
+    Matrix X(static_cast<int>(rows.size()), kPRP);
+    double* out = X.GetData();
+    for (std::size_t i = 0; i < rows.size(); i++, out += X.GetStride()) {
+        const int r = rows[i];
+        if (r < 0 || r >= mNumRows) {
+            throw std::out_of_range("Row index out of range");
+        }
+        for (int f = 0; f < kPRP; f++) out[f] = mColumnViews[f][r];
+    }
+    return X;
+}
+
+/**
+ * Gathers PRP and ERP of the selected rows
+ * @param rows 0-based row indices, in the order wanted
+ * @return rows.size() x 2 target matrix (PRP, ERP)
+ */
+Matrix HardwareDataset::CreateTargetMatrix(const std::vector<int>& rows) const {
+    Matrix Y(static_cast<int>(rows.size()), 2);
+    double* out = Y.GetData();
+    for (std::size_t i = 0; i < rows.size(); i++, out += Y.GetStride()) {
+        const int r = rows[i];
+        if (r < 0 || r >= mNumRows) {
+            throw std::out_of_range("Row index out of range");
+        }
+        out[0] = mColumnViews[kPRP][r];
+        out[1] = mColumnViews[kERP][r];
+    }
+    return Y;
+}
@@ -0,0 +1,38 @@
+#include "LeastSquares.h"
+
+/**
+ * Factorizes the design matrix
+ * @param X Design matrix, one observation per row
+ * @throws std::invalid_argument if X has fewer rows than columns
+ */
+LeastSquares::LeastSquares(const Matrix& X) : mQR(X) {}
+
+/**
+ * Fits one target
+ * @param y Observed values, one per row of X
+ * @return Coefficients beta minimizing ||X beta - y||
+ * @throws std::invalid_argument if y has the wrong size
+ * @throws std::runtime_error if X is rank deficient
+ */
+Vector LeastSquares::Solve(const Vector& y) const {
+    return mQR.Solve(y);
+}
+
+/**
+ * Fits several targets with the same factorization
+ * @param Y Observed values, one column per target
+ * @return Coefficients, one column per target
+ * @throws std::invalid_argument if Y has the wrong number of rows
+ * @throws std::runtime_error if X is rank deficient
+ */
+Matrix LeastSquares::Solve(const Matrix& Y) const {
+    return mQR.Solve(Y);
+}
+
+int LeastSquares::GetRank() const {
+    return mQR.GetRank();
+}
+
+const QRFactorization& LeastSquares::GetFactorization() const {
+    return mQR;
+}
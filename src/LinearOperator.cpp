@@ -0,0 +1,53 @@
+#include "LinearOperator.h"
+#include <stdexcept>
+
+LinearOperator::~LinearOperator() {}
+
+FunctionOperator::FunctionOperator(int numRows, int numCols, const Callback& apply,
+                                   const Callback& applyTranspose)
+    : mNumRows(numRows), mNumCols(numCols), mApply(apply), mApplyTranspose(applyTranspose) {
+    if (numRows < 0 || numCols < 0) {
+        throw std::invalid_argument("Operator dimensions must be non-negative");
+    }
+    if (!mApply) {
+        throw std::invalid_argument("FunctionOperator requires an apply callback");
+    }
+    if (!mApplyTranspose && numRows != numCols) {
+        throw std::invalid_argument("A non-square FunctionOperator requires a transpose callback");
+    }
+}
+
+int FunctionOperator::GetNumRows() const { return mNumRows; }
+int FunctionOperator::GetNumCols() const { return mNumCols; }
+
+void FunctionOperator::Apply(const Vector& x, Vector& y) const {
+    if (x.GetSize() != mNumCols || y.GetSize() != mNumRows) {
+        throw std::invalid_argument("Operator and vector dimensions must be compatible");
+    }
+    mApply(x, y);
+}
+
+void FunctionOperator::ApplyTranspose(const Vector& x, Vector& y) const {
+    if (x.GetSize() != mNumRows || y.GetSize() != mNumCols) {
+        throw std::invalid_argument("Operator and vector dimensions must be compatible");
+    }
+    if (mApplyTranspose) {
+        mApplyTranspose(x, y);
+    } else {
+        mApply(x, y);
+    }
+}
+
+NormalOperator::NormalOperator(const LinearOperator& X) : mX(X), mScratch(X.GetNumRows()) {}
+
+int NormalOperator::GetNumRows() const { return mX.GetNumCols(); }
+int NormalOperator::GetNumCols() const { return mX.GetNumCols(); }
+
+void NormalOperator::Apply(const Vector& x, Vector& y) const {
+    mX.Apply(x, mScratch);
+    mX.ApplyTranspose(mScratch, y);
+}
+
+void NormalOperator::ApplyTranspose(const Vector& x, Vector& y) const {
+    Apply(x, y);   // X^T X is symmetric
+}
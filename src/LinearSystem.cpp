@@ -1,7 +1,5 @@
 #include "LinearSystem.h"
 #include <stdexcept>
-#include <cmath>
-#include <algorithm>
 
 /**
  * Constructor for LinearSystem
@@ -10,7 +8,8 @@
  * @throws std::invalid_argument if A is not square or dimensions don't match
  * @throws std::runtime_error if memory allocation fails
  */
-LinearSystem::LinearSystem(const Matrix& A, const Vector& b) {
+LinearSystem::LinearSystem(const Matrix& A, const Vector& b)
+    : mpLU(nullptr), mPrecision(SolverPrecision::Double), mpMixed(nullptr) {
     if (!A.IsSquare()) {
         throw std::invalid_argument("Matrix A must be square");
     }
@@ -28,71 +27,71 @@ LinearSystem::LinearSystem(const Matrix& A, const Vector& b) {
 }
 
 LinearSystem::~LinearSystem() {
+    delete mpMixed;   // Refers to *mpA
+    delete mpLU;
     delete mpA;
     delete mpb;
 }
 
 /**
- * Solves the linear system Ax = b using Gaussian elimination with partial pivoting
- * @return Solution vector x
- * @throws std::runtime_error if the matrix is singular or nearly singular
+ * Returns the LU factorization of A, computing it on the first call
+ * @return Cached factorization (safe to call from several threads)
  */
-Vector LinearSystem::Solve() const {
-    // Check if the system is well-defined
+const LUFactorization& LinearSystem::GetFactorization() const {
     if (mSize == 0 || !mpA || !mpb) {
         throw std::runtime_error("Linear system is not properly initialized");
     }
+    std::call_once(mLUOnce, [this]() { mpLU = new LUFactorization(*mpA); });
+    return *mpLU;
+}
 
-    const double epsilon = 1e-10;  // Threshold for considering a matrix singular
-    
-    // Create copies for manipulation
-    Matrix A(*mpA);
-    Vector b(*mpb);
-    
-    // Gaussian elimination with partial pivoting
-    for (int k = 1; k <= mSize; k++) {
-        // Partial pivoting
-        int maxRow = k;
-        double maxVal = std::abs(A(k, k));
-        for (int i = k+1; i <= mSize; i++) {
-            if (std::abs(A(i, k)) > maxVal) {
-                maxVal = std::abs(A(i, k));
-                maxRow = i;
-            }
-        }
-        
-        // Check for singular matrix
-        if (maxVal < epsilon) {
-            throw std::runtime_error("Matrix is singular or nearly singular");
-        }
-        
-        // Swap rows if necessary
-        if (maxRow != k) {
-            for (int j = k; j <= mSize; j++) {
-                std::swap(A(k, j), A(maxRow, j));
-            }
-            std::swap(b(k), b(maxRow));
-        }
-        
-        // Elimination
-        for (int i = k+1; i <= mSize; i++) {
-            double factor = A(i, k) / A(k, k);
-            for (int j = k; j <= mSize; j++) {
-                A(i, j) -= factor * A(k, j);
-            }
-            b(i) -= factor * b(k);
-        }
-    }
-    
-    // Back substitution
-    Vector x(mSize);
-    for (int i = mSize; i >= 1; i--) {
-        double sum = 0.0;
-        for (int j = i+1; j <= mSize; j++) {
-            sum += A(i, j) * x(j);
-        }
-        x(i) = (b(i) - sum) / A(i, i);
+/**
+ * Returns the mixed-precision factorization of A, computing it on the first call
+ * @return Cached factorization (safe to call from several threads)
+ */
+const MixedPrecisionLU& LinearSystem::GetMixedFactorization() const {
+    if (mSize == 0 || !mpA || !mpb) {
+        throw std::runtime_error("Linear system is not properly initialized");
     }
-    
-    return x;
-}
\ No newline at end of file
+    std::call_once(mMixedOnce, [this]() { mpMixed = new MixedPrecisionLU(*mpA); });
+    return *mpMixed;
+}
+
+void LinearSystem::SetPrecision(SolverPrecision precision) { mPrecision = precision; }
+SolverPrecision LinearSystem::GetPrecision() const { return mPrecision; }
+
+/**
+ * Solves the linear system Ax = b using Gaussian elimination with partial pivoting.
+ * The factors are computed once; later calls only do the O(n^2) substitutions.
+ * With SolverPrecision::Mixed the factors are float and x is refined to
+ * double accuracy.
+ * @return Solution vector x
+ * @throws std::runtime_error if the matrix is singular or nearly singular
+ */
+Vector LinearSystem::Solve() const {
+    return LinearSystem::Solve(*mpb);
+}
+
+/**
+ * Solves Ax = b for a new right-hand side, reusing the cached factors
+ * @param b Vector of constants
+ * @return Solution vector x
+ * @throws std::invalid_argument if b has the wrong size
+ * @throws std::runtime_error if the matrix is singular or nearly singular
+ */
+Vector LinearSystem::Solve(const Vector& b) const {
+    if (mPrecision == SolverPrecision::Mixed) return GetMixedFactorization().Solve(b);
+    return GetFactorization().Solve(b);
+}
+
+/**
+ * Solves AX = B for several right-hand sides at once (one per column of B)
+ * @param B Matrix of constants
+ * @return Solution matrix X
+ * @throws std::invalid_argument if B has the wrong number of rows
+ * @throws std::runtime_error if the matrix is singular or nearly singular
+ */
+Matrix LinearSystem::Solve(const Matrix& B) const {
+    if (mPrecision == SolverPrecision::Mixed) return GetMixedFactorization().Solve(B);
+    return GetFactorization().Solve(B);
+}
@@ -0,0 +1,74 @@
+#include "MappedFile.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+// The view keeps the mapping alive, so both handles are closed right away
+MappedFile::MappedFile(const std::string& filename) : mData(nullptr), mSize(0) {
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        throw std::runtime_error("Could not map empty file: " + filename);
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        throw std::runtime_error("Could not map file: " + filename);
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) {
+        throw std::runtime_error("Could not map file: " + filename);
+    }
+    mData = static_cast<const char*>(view);
+    mSize = static_cast<std::size_t>(size.QuadPart);
+}
+
+MappedFile::~MappedFile() {
+    UnmapViewOfFile(mData);
+}
+#else
+// The mapping outlives the descriptor, which is closed right away
+MappedFile::MappedFile(const std::string& filename) : mData(nullptr), mSize(0) {
+    const int descriptor = open(filename.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    struct stat info;
+    if (fstat(descriptor, &info) != 0 || info.st_size == 0) {
+        close(descriptor);
+        throw std::runtime_error("Could not map empty file: " + filename);
+    }
+    void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Could not map file: " + filename);
+    }
+    mData = static_cast<const char*>(view);
+    mSize = static_cast<std::size_t>(info.st_size);
+}
+
+MappedFile::~MappedFile() {
+    munmap(const_cast<char*>(mData), mSize);
+}
+#endif
+
+const char* MappedFile::GetData() const { return mData; }
+
+std::size_t MappedFile::GetSize() const { return mSize; }
@@ -1,49 +1,81 @@
 #include "Matrix.h"
+#include "AlignedMemory.h"
+#include "Gemm.h"
+#include "LUFactorization.h"
+#include "QRFactorization.h"
+#include "SingularValueDecomposition.h"
+#include "ThreadPool.h"
 #include <cmath>
 #include <stdexcept>
 #include <iostream>
 #include <algorithm>
 #include <iomanip>
+#include <cstring>
 
+namespace {
+// Tile edge used by Transpose so that both source and destination tiles stay in L1.
+const int kTransposeTile = 32;
+
+// Elements per parallel task; smaller matrices run on the calling thread
+const int kParallelElements = 1 << 15;
+
+// MultiplyTranspose reduces at most this many row bands, each of at least
+// kParallelElements elements. The cut depends only on the shape, so the
+// rounding is the same for any number of threads.
+const int kMaxBands = 64;
+}
+
+int Matrix::RowGrain(int numCols) {
+    return std::max(1, kParallelElements / std::max(1, numCols));
+}
+
+// One aligned allocation for the whole matrix. Padding columns are zeroed so
+// kernels may safely read full padded rows.
 void Matrix::AllocateMemory() {
-    mData = new double*[mNumRows];
-    for (int i = 0; i < mNumRows; i++) {
-        mData[i] = new double[mNumCols];
-    }
+    mStride = PaddedStride(mNumCols, sizeof(double));
+    const std::size_t count = static_cast<std::size_t>(mNumRows) * mStride;
+    mData = static_cast<double*>(AllocateAligned(count * sizeof(double)));
+    if (mData) std::memset(mData, 0, count * sizeof(double));
 }
 
 void Matrix::DeallocateMemory() {
-    for (int i = 0; i < mNumRows; i++) {
-        delete[] mData[i];
-    }
-    delete[] mData;
+    FreeAligned(mData);
+    mData = nullptr;
 }
 
 void Matrix::CopyData(const Matrix& other) {
+    if (mStride == other.mStride) {
+        std::memcpy(mData, other.mData,
+                    static_cast<std::size_t>(mNumRows) * mStride * sizeof(double));
+        return;
+    }
     for (int i = 0; i < mNumRows; i++) {
-        for (int j = 0; j < mNumCols; j++) {
-            mData[i][j] = other.mData[i][j];
-        }
+        std::memcpy(mData + static_cast<std::size_t>(i) * mStride,
+                    other.mData + static_cast<std::size_t>(i) * other.mStride,
+                    mNumCols * sizeof(double));
     }
 }
 
-Matrix::Matrix() : mNumRows(0), mNumCols(0), mData(nullptr) {}
+Matrix::Matrix() : mNumRows(0), mNumCols(0), mStride(0), mData(nullptr) {}
 
-Matrix::Matrix(int numRows, int numCols) : mNumRows(numRows), mNumCols(numCols) {
+Matrix::Matrix(int numRows, int numCols) : mNumRows(numRows), mNumCols(numCols), mStride(0), mData(nullptr) {
     if (numRows <= 0 || numCols <= 0) throw std::invalid_argument("Matrix dimensions must be positive");
     AllocateMemory();
-    for (int i = 0; i < mNumRows; i++) {
-        for (int j = 0; j < mNumCols; j++) {
-            mData[i][j] = 0.0;
-        }
-    }
 }
 
-Matrix::Matrix(const Matrix& other) : mNumRows(other.mNumRows), mNumCols(other.mNumCols) {
+Matrix::Matrix(const Matrix& other) : mNumRows(other.mNumRows), mNumCols(other.mNumCols), mStride(0), mData(nullptr) {
     AllocateMemory();
     CopyData(other);
 }
 
+Matrix::Matrix(Matrix&& other) noexcept
+    : mNumRows(other.mNumRows), mNumCols(other.mNumCols), mStride(other.mStride), mData(other.mData) {
+    other.mNumRows = 0;
+    other.mNumCols = 0;
+    other.mStride = 0;
+    other.mData = nullptr;
+}
+
 Matrix::~Matrix() {
     DeallocateMemory();
 }
@@ -54,107 +86,188 @@ int Matrix::GetNumCols() const { return mNumCols; }
 double& Matrix::operator()(int i, int j) {
     if (i < 1 || i > mNumRows || j < 1 || j > mNumCols) 
         throw std::out_of_range("Matrix index out of range");
-    return mData[i-1][j-1];
+    return mData[static_cast<std::size_t>(i-1) * mStride + (j-1)];
 }
 
 const double& Matrix::operator()(int i, int j) const {
     if (i < 1 || i > mNumRows || j < 1 || j > mNumCols) 
         throw std::out_of_range("Matrix index out of range");
-    return mData[i-1][j-1];
+    return mData[static_cast<std::size_t>(i-1) * mStride + (j-1)];
 }
 
+double* Matrix::GetData() { return mData; }
+const double* Matrix::GetData() const { return mData; }
+int Matrix::GetStride() const { return mStride; }
+
 Matrix& Matrix::operator=(const Matrix& other) {
+    if (this != &other) {
+        // Reuse the existing buffer when the shape is unchanged
+        if (mNumRows != other.mNumRows || mNumCols != other.mNumCols) {
+            DeallocateMemory();
+            mNumRows = other.mNumRows;
+            mNumCols = other.mNumCols;
+            AllocateMemory();
+        }
+        CopyData(other);
+    }
+    return *this;
+}
+
+Matrix& Matrix::operator=(Matrix&& other) noexcept {
     if (this != &other) {
         DeallocateMemory();
         mNumRows = other.mNumRows;
         mNumCols = other.mNumCols;
-        AllocateMemory();
-        CopyData(other);
+        mStride = other.mStride;
+        mData = other.mData;
+        other.mNumRows = 0;
+        other.mNumCols = 0;
+        other.mStride = 0;
+        other.mData = nullptr;
     }
     return *this;
 }
 
-Matrix Matrix::operator+() const { return *this; }
+Matrix& Matrix::operator+=(const Matrix& other) {
+    return Axpy(1.0, other);
+}
 
-Matrix Matrix::operator-() const {
-    Matrix result(mNumRows, mNumCols);
-    for (int i = 0; i < mNumRows; i++) {
-        for (int j = 0; j < mNumCols; j++) {
-            result.mData[i][j] = -mData[i][j];
-        }
-    }
-    return result;
+Matrix& Matrix::operator-=(const Matrix& other) {
+    return Axpy(-1.0, other);
 }
 
-Matrix Matrix::operator+(const Matrix& other) const {
-    if (mNumRows != other.mNumRows || mNumCols != other.mNumCols)
-        throw std::invalid_argument("Matrix dimensions must match");
-    Matrix result(mNumRows, mNumCols);
-    for (int i = 0; i < mNumRows; i++) {
-        for (int j = 0; j < mNumCols; j++) {
-            result.mData[i][j] = mData[i][j] + other.mData[i][j];
+Matrix& Matrix::operator*=(double scalar) {
+    ThreadPool::Global().ParallelFor(0, mNumRows, RowGrain(mNumCols), [&](int first, int last) {
+        for (int i = first; i < last; i++) {
+            double* row = mData + static_cast<std::size_t>(i) * mStride;
+            for (int j = 0; j < mNumCols; j++) {
+                row[j] *= scalar;
+            }
         }
-    }
-    return result;
+    });
+    return *this;
 }
 
-Matrix Matrix::operator-(const Matrix& other) const {
-    if (mNumRows != other.mNumRows || mNumCols != other.mNumCols)
+Matrix& Matrix::Axpy(double alpha, const Matrix& x) {
+    if (mNumRows != x.mNumRows || mNumCols != x.mNumCols)
         throw std::invalid_argument("Matrix dimensions must match");
-    Matrix result(mNumRows, mNumCols);
-    for (int i = 0; i < mNumRows; i++) {
-        for (int j = 0; j < mNumCols; j++) {
-            result.mData[i][j] = mData[i][j] - other.mData[i][j];
+    ThreadPool::Global().ParallelFor(0, mNumRows, RowGrain(mNumCols), [&](int first, int last) {
+        for (int i = first; i < last; i++) {
+            double* dst = mData + static_cast<std::size_t>(i) * mStride;
+            const double* src = x.mData + static_cast<std::size_t>(i) * x.mStride;
+            for (int j = 0; j < mNumCols; j++) {
+                dst[j] += alpha * src[j];
+            }
         }
-    }
-    return result;
+    });
+    return *this;
 }
 
+Matrix Matrix::operator+() const { return *this; }
+
 Matrix Matrix::operator*(const Matrix& other) const {
     if (mNumCols != other.mNumRows)
         throw std::invalid_argument("Matrix dimensions must be compatible for multiplication");
     Matrix result(mNumRows, other.mNumCols);
-    for (int i = 0; i < mNumRows; i++) {
-        for (int j = 0; j < other.mNumCols; j++) {
-            result.mData[i][j] = 0.0;
-            for (int k = 0; k < mNumCols; k++) {
-                result.mData[i][j] += mData[i][k] * other.mData[k][j];
-            }
-        }
-    }
+    Gemm(false, false, mNumRows, other.mNumCols, mNumCols,
+         1.0, mData, mStride, other.mData, other.mStride,
+         0.0, result.mData, result.mStride);
     return result;
 }
 
 Vector Matrix::operator*(const Vector& vec) const {
+    Vector result(mNumRows);
+    Multiply(vec, result);
+    return result;
+}
+
+void Matrix::Multiply(const Vector& vec, Vector& result) const {
     if (mNumCols != vec.GetSize())
         throw std::invalid_argument("Matrix and vector dimensions must be compatible");
-    Vector result(mNumRows);
-    for (int i = 0; i < mNumRows; i++) {
-        result[i] = 0.0;
-        for (int j = 0; j < mNumCols; j++) {
-            result[i] += mData[i][j] * vec[j];
+    if (result.GetSize() != mNumRows)
+        throw std::invalid_argument("Result vector has the wrong size");
+    if (&vec == &result)
+        throw std::invalid_argument("Result vector must not alias the input");
+    const double* x = vec.GetData();
+    double* y = result.GetData();
+    ThreadPool::Global().ParallelFor(0, mNumRows, RowGrain(mNumCols), [&](int first, int last) {
+        for (int i = first; i < last; i++) {
+            const double* row = mData + static_cast<std::size_t>(i) * mStride;
+            double sum = 0.0;
+            for (int j = 0; j < mNumCols; j++) {
+                sum += row[j] * x[j];
+            }
+            y[i] = sum;
         }
-    }
-    return result;
+    });
 }
 
-Matrix Matrix::operator*(double scalar) const {
-    Matrix result(mNumRows, mNumCols);
-    for (int i = 0; i < mNumRows; i++) {
-        for (int j = 0; j < mNumCols; j++) {
-            result.mData[i][j] = mData[i][j] * scalar;
+void Matrix::MultiplyTranspose(const Vector& vec, Vector& result) const {
+    if (mNumRows != vec.GetSize())
+        throw std::invalid_argument("Matrix and vector dimensions must be compatible");
+    if (result.GetSize() != mNumCols)
+        throw std::invalid_argument("Result vector has the wrong size");
+    if (&vec == &result)
+        throw std::invalid_argument("Result vector must not alias the input");
+    const double* x = vec.GetData();
+    double* y = result.GetData();
+
+    // Rows are streamed in fixed bands; each band accumulates its own partial
+    // sum of rows and the partials are added in band order (deterministic)
+    const long long elements = static_cast<long long>(mNumRows) * mNumCols;
+    const int numBands = static_cast<int>(std::max(1LL, std::min<long long>(kMaxBands, elements / kParallelElements)));
+    for (int j = 0; j < mNumCols; j++) y[j] = 0.0;
+    if (numBands == 1) {
+        for (int i = 0; i < mNumRows; i++) {
+            const double* row = mData + static_cast<std::size_t>(i) * mStride;
+            const double xi = x[i];
+            for (int j = 0; j < mNumCols; j++) y[j] += row[j] * xi;
         }
+        return;
+    }
+
+    std::vector<double> partial(static_cast<std::size_t>(numBands) * mNumCols, 0.0);
+    ThreadPool::Global().ParallelFor(0, numBands, 1, [&](int first, int last) {
+        for (int band = first; band < last; band++) {
+            double* acc = partial.data() + static_cast<std::size_t>(band) * mNumCols;
+            const int rowBegin = static_cast<int>(static_cast<long long>(mNumRows) * band / numBands);
+            const int rowEnd = static_cast<int>(static_cast<long long>(mNumRows) * (band + 1) / numBands);
+            for (int i = rowBegin; i < rowEnd; i++) {
+                const double* row = mData + static_cast<std::size_t>(i) * mStride;
+                const double xi = x[i];
+                for (int j = 0; j < mNumCols; j++) acc[j] += row[j] * xi;
+            }
+        }
+    });
+    for (int band = 0; band < numBands; band++) {
+        const double* acc = partial.data() + static_cast<std::size_t>(band) * mNumCols;
+        for (int j = 0; j < mNumCols; j++) y[j] += acc[j];
     }
-    return result;
 }
 
+void Matrix::Apply(const Vector& x, Vector& y) const { Multiply(x, y); }
+void Matrix::ApplyTranspose(const Vector& x, Vector& y) const { MultiplyTranspose(x, y); }
+
 Matrix Matrix::Transpose() const {
     Matrix result(mNumCols, mNumRows);
-    for (int i = 0; i < mNumRows; i++) {
-        for (int j = 0; j < mNumCols; j++) {
-            result.mData[j][i] = mData[i][j];
+    // Tiled so that reads and writes both stay within a few cache lines;
+    // tasks take whole bands of source tile rows
+    const int numTileRows = (mNumRows + kTransposeTile - 1) / kTransposeTile;
+    const int tileGrain = std::max(1, RowGrain(mNumCols) / kTransposeTile);
+    ThreadPool::Global().ParallelFor(0, numTileRows, tileGrain, [&](int first, int last) {
+        for (int ii = first * kTransposeTile; ii < std::min(last * kTransposeTile, mNumRows); ii += kTransposeTile) {
+            const int iEnd = std::min(ii + kTransposeTile, mNumRows);
+            for (int jj = 0; jj < mNumCols; jj += kTransposeTile) {
+                const int jEnd = std::min(jj + kTransposeTile, mNumCols);
+                for (int i = ii; i < iEnd; i++) {
+                    const double* src = mData + static_cast<std::size_t>(i) * mStride;
+                    for (int j = jj; j < jEnd; j++) {
+                        result.mData[static_cast<std::size_t>(j) * result.mStride + i] = src[j];
+                    }
+                }
+            }
         }
-    }
+    });
     return result;
 }
 
@@ -170,13 +283,15 @@ Matrix Matrix::SubMatrix(int excludeRow, int excludeCol) const {
             rowOffset = 1;
             continue;
         }
+        const double* src = mData + static_cast<std::size_t>(i) * mStride;
+        double* dst = result.mData + static_cast<std::size_t>(i-rowOffset) * result.mStride;
         int colOffset = 0;
         for (int j = 0; j < mNumCols; j++) {
             if (j == excludeCol-1) {
                 colOffset = 1;
                 continue;
             }
-            result.mData[i-rowOffset][j-colOffset] = mData[i][j];
+            dst[j-colOffset] = src[j];
         }
     }
     return result;
@@ -185,51 +300,47 @@ Matrix Matrix::SubMatrix(int excludeRow, int excludeCol) const {
 double Matrix::Determinant() const {
     if (!IsSquare()) throw std::runtime_error("Matrix must be square to compute determinant");
     
-    if (mNumRows == 1) return mData[0][0];
-    if (mNumRows == 2) return mData[0][0] * mData[1][1] - mData[0][1] * mData[1][0];
+    if (mNumRows == 1) return mData[0];
+    if (mNumRows == 2) return mData[0] * mData[mStride + 1] - mData[1] * mData[mStride];
     
-    double det = 0.0;
-    for (int j = 0; j < mNumCols; j++) {
-        Matrix subMatrix = SubMatrix(1, j+1);
-        double sign = (j % 2 == 0) ? 1.0 : -1.0;
-        det += sign * mData[0][j] * subMatrix.Determinant();
-    }
-    return det;
+    // Product of the LU pivots: O(n^3) instead of cofactor expansion
+    return LUFactorization(*this).Determinant();
+}
+
+double Matrix::LogDeterminant(int& sign) const {
+    if (!IsSquare()) throw std::runtime_error("Matrix must be square to compute determinant");
+    return LUFactorization(*this).LogAbsDeterminant(sign);
 }
 
 Matrix Matrix::Inverse() const {
     if (!IsSquare()) throw std::runtime_error("Matrix must be square to compute inverse");
-    double det = Determinant();
-    if (std::abs(det) < 1e-10) throw std::runtime_error("Matrix is singular (determinant is zero)");
+    LUFactorization lu(*this);
+    if (lu.IsSingular()) throw std::runtime_error("Matrix is singular (determinant is zero)");
     
-    if (mNumRows == 1) {
-        Matrix inverse(1, 1);
-        inverse(1, 1) = 1.0 / mData[0][0];
-        return inverse;
-    }
-    
-    Matrix adjugate(mNumRows, mNumCols);
+    // Solve A X = I, one triangular solve pair per column
+    Matrix identity(mNumRows, mNumCols);
     for (int i = 0; i < mNumRows; i++) {
-        for (int j = 0; j < mNumCols; j++) {
-            Matrix subMatrix = SubMatrix(i+1, j+1);
-            double sign = ((i + j) % 2 == 0) ? 1.0 : -1.0;
-            adjugate(j+1, i+1) = sign * subMatrix.Determinant(); // Note the transpose
-        }
+        identity.mData[static_cast<std::size_t>(i) * identity.mStride + i] = 1.0;
     }
-    
-    return adjugate * (1.0 / det);
+    return lu.Solve(identity);
 }
 
 Matrix Matrix::PseudoInverse() const {
+    // From a QR of A (or of A^T when A is wide) rather than inverting the Gram
+    // matrix, which would square the condition number. Rank-deficient input
+    // falls back to the SVD with the default cutoff.
     if (mNumRows >= mNumCols) {
-        Matrix ATA = Transpose() * (*this);
-        Matrix ATAInv = ATA.Inverse();
-        return ATAInv * Transpose();
+        QRFactorization qr(*this);
+        if (qr.IsFullRank()) return qr.PseudoInverse();
     } else {
-        Matrix AAT = (*this) * Transpose();
-        Matrix AATInv = AAT.Inverse();
-        return Transpose() * AATInv;
+        QRFactorization qr(Transpose());
+        if (qr.IsFullRank()) return qr.PseudoInverse().Transpose();
     }
+    return PseudoInverse(-1.0);
+}
+
+Matrix Matrix::PseudoInverse(double tolerance) const {
+    return SingularValueDecomposition(*this).PseudoInverse(tolerance);
 }
 
 void Matrix::Print() const {
@@ -237,7 +348,7 @@ void Matrix::Print() const {
     for (int i = 0; i < mNumRows; i++) {
         std::cout << "[ ";
         for (int j = 0; j < mNumCols; j++) {
-            std::cout << std::setw(8) << mData[i][j] << " ";
+            std::cout << std::setw(8) << mData[static_cast<std::size_t>(i) * mStride + j] << " ";
         }
         std::cout << "]" << std::endl;
     }
@@ -251,14 +362,11 @@ bool Matrix::IsSymmetric() const {
     const double epsilon = 1e-10;  // Tolerance for floating-point comparison
     for (int i = 0; i < mNumRows; i++) {
         for (int j = i + 1; j < mNumCols; j++) {
-            if (std::abs(mData[i][j] - mData[j][i]) > epsilon) {
+            if (std::abs(mData[static_cast<std::size_t>(i) * mStride + j] -
+                         mData[static_cast<std::size_t>(j) * mStride + i]) > epsilon) {
                 return false;
             }
         }
     }
     return true;
 }
-
-Matrix operator*(double scalar, const Matrix& mat) {
-    return mat * scalar;
-}
\ No newline at end of file
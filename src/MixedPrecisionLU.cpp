@@ -0,0 +1,166 @@
+#include "MixedPrecisionLU.h"
+#include "AlignedMemory.h"
+#include "LUKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+// Refinement is abandoned when a correction fails to shrink the residual
+// by at least this factor: A is too ill-conditioned for the float factors
+const double kStallRatio = 0.5;
+
+double InfinityNorm(const Vector& v) {
+    double norm = 0.0;
+    for (int i = 0; i < v.GetSize(); i++) norm = std::max(norm, std::abs(v[i]));
+    return norm;
+}
+
+double BackwardError(double residualNorm, double normA, double normX, double normB) {
+    const double scale = normA * normX + normB;
+    return scale > 0.0 ? residualNorm / scale : residualNorm;
+}
+}
+
+/**
+ * Converts A to float and factorizes it
+ * @param A Square matrix; kept by reference for the residuals, so it must
+ *          outlive the solver and stay unchanged
+ * @param options Stopping rule of the refinement
+ * @throws std::invalid_argument if A is not square
+ */
+MixedPrecisionLU::MixedPrecisionLU(const Matrix& A, const RefinementOptions& options)
+    : mSize(A.GetNumRows()), mpA(&A), mNormA(0.0), mpLowLU(nullptr), mLowStride(0), mLowPivots(),
+      mLowUsable(false), mOptions(options), mpFallback(nullptr) {
+    if (!A.IsSquare()) {
+        throw std::invalid_argument("Matrix must be square for LU factorization");
+    }
+    const int n = mSize;
+    const double* a = A.GetData();
+    const int lda = A.GetStride();
+
+    mLowStride = PaddedStride(n, sizeof(float));
+    mpLowLU = static_cast<float*>(AllocateAligned(static_cast<std::size_t>(n) * mLowStride * sizeof(float)));
+    mLowPivots.assign(n, 0);
+
+    // ||A|| and the float copy in one pass; a row beyond the float range
+    // rules the float factors out
+    bool fits = true;
+    for (int i = 0; i < n; i++) {
+        const double* row = a + static_cast<std::size_t>(i) * lda;
+        float* lowRow = mpLowLU + static_cast<std::size_t>(i) * mLowStride;
+        double sum = 0.0;
+        for (int j = 0; j < n; j++) {
+            sum += std::abs(row[j]);
+            lowRow[j] = static_cast<float>(row[j]);
+        }
+        mNormA = std::max(mNormA, sum);
+        if (sum > std::numeric_limits<float>::max()) fits = false;
+    }
+
+    if (fits && n > 0) {
+        int permutationSign = 1;
+        bool singular = false;
+        FactorizeLU(n, mpLowLU, mLowStride, mLowPivots.data(), permutationSign, singular);
+        mLowUsable = !singular;
+    }
+}
+
+MixedPrecisionLU::~MixedPrecisionLU() {
+    FreeAligned(mpLowLU);
+    delete mpFallback;
+}
+
+int MixedPrecisionLU::GetSize() const { return mSize; }
+bool MixedPrecisionLU::IsLowPrecisionUsable() const { return mLowUsable; }
+
+const LUFactorization& MixedPrecisionLU::GetFallback() const {
+    std::call_once(mFallbackOnce, [this]() { mpFallback = new LUFactorization(*mpA); });
+    return *mpFallback;
+}
+
+/**
+ * Solves Ax = b to double accuracy from the float factors
+ * @param b Right-hand side
+ * @param result Receives the refinement statistics if not null
+ * @return Solution vector x
+ * @throws std::invalid_argument if b has the wrong size
+ * @throws std::runtime_error if the matrix is singular or nearly singular
+ */
+Vector MixedPrecisionLU::Solve(const Vector& b, RefinementResult* result) const {
+    if (b.GetSize() != mSize) {
+        throw std::invalid_argument("Right-hand side size does not match the factorized matrix");
+    }
+    const int n = mSize;
+    const double normB = InfinityNorm(b);
+    const double tolerance = mOptions.tolerance > 0.0
+        ? mOptions.tolerance
+        : std::sqrt(static_cast<double>(n)) * std::numeric_limits<double>::epsilon();
+
+    RefinementResult stats;
+    Vector x(n);
+    Vector r(n);
+    if (mLowUsable && normB <= std::numeric_limits<float>::max()) {
+        std::vector<float> work(n);
+        r = b;
+        double residualNorm = normB;
+        double previousNorm = std::numeric_limits<double>::infinity();
+        for (int iteration = 0; ; iteration++) {
+            if (residualNorm <= tolerance * mNormA * InfinityNorm(x)) {
+                stats.converged = true;
+                break;
+            }
+            if (iteration > mOptions.maxIterations || residualNorm > kStallRatio * previousNorm) break;
+
+            // d = A^-1 r in float; r is scaled to unit size first so that a
+            // small residual neither underflows nor loses float precision
+            const double scale = residualNorm > 0.0 ? residualNorm : 1.0;
+            for (int i = 0; i < n; i++) work[i] = static_cast<float>(r[i] / scale);
+            SolveLU(n, mpLowLU, mLowStride, mLowPivots.data(), work.data());
+            double* px = x.GetData();
+            for (int i = 0; i < n; i++) px[i] += scale * work[i];
+            if (iteration > 0) stats.iterations++;
+
+            // r = b - A x in double
+            mpA->Multiply(x, r);
+            r = b - r;
+            previousNorm = residualNorm;
+            residualNorm = InfinityNorm(r);
+        }
+        if (stats.converged) {
+            stats.backwardError = BackwardError(residualNorm, mNormA, InfinityNorm(x), normB);
+        }
+    }
+
+    if (!stats.converged) {
+        x = GetFallback().Solve(b);
+        stats.usedFallback = true;
+        mpA->Multiply(x, r);
+        r = b - r;
+        stats.backwardError = BackwardError(InfinityNorm(r), mNormA, InfinityNorm(x), normB);
+    }
+    if (result) *result = stats;
+    return x;
+}
+
+/**
+ * Solves AX = B column by column
+ * @param B Right-hand sides, one per column
+ * @return Solution matrix X
+ * @throws std::invalid_argument if B has the wrong number of rows
+ * @throws std::runtime_error if the matrix is singular or nearly singular
+ */
+Matrix MixedPrecisionLU::Solve(const Matrix& B) const {
+    if (B.GetNumRows() != mSize) {
+        throw std::invalid_argument("Right-hand side size does not match the factorized matrix");
+    }
+    Matrix X(mSize, B.GetNumCols());
+    Vector column(mSize);
+    for (int j = 1; j <= B.GetNumCols(); j++) {
+        for (int i = 1; i <= mSize; i++) column(i) = B(i, j);
+        Vector x = Solve(column);
+        for (int i = 1; i <= mSize; i++) X(i, j) = x(i);
+    }
+    return X;
+}
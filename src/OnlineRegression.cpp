@@ -0,0 +1,217 @@
+#include "OnlineRegression.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+OnlineRegression::OnlineRegression(int numFeatures, int numTargets, double forgetting, double ridge)
+    : mNumFeatures(numFeatures), mNumTargets(numTargets), mForgetting(forgetting), mTotalWeight(0.0) {
+    if (numFeatures <= 0 || numTargets <= 0) {
+        throw std::invalid_argument("Feature and target counts must be positive");
+    }
+    if (!(forgetting > 0.0 && forgetting <= 1.0) || !(ridge >= 0.0)) {
+        throw std::invalid_argument("Forgetting factor must be in (0, 1] and ridge non-negative");
+    }
+    mR = Matrix(numFeatures, numFeatures);
+    mRotatedTargets = Matrix(numFeatures, numTargets);
+    mResidualSquares = Vector(numTargets);
+    mScratch.resize(3 * numFeatures + numTargets);
+    for (int i = 1; i <= numFeatures; i++) mR(i, i) = std::sqrt(ridge);
+}
+
+/**
+ * Takes over the accumulator's factor, whose [R | d] and residuals have the
+ * same meaning as here
+ * @param initial Accumulated observations, each with weight 1
+ * @param forgetting Factor applied on every later addition
+ * @throws std::invalid_argument unless 0 < forgetting <= 1
+ */
+OnlineRegression::OnlineRegression(const RegressionAccumulator& initial, double forgetting)
+    : mNumFeatures(initial.GetNumFeatures()), mNumTargets(initial.GetNumTargets()),
+      mForgetting(forgetting), mTotalWeight(static_cast<double>(initial.GetNumRows())),
+      mR(initial.GetR()), mRotatedTargets(initial.GetRotatedTargets()),
+      mResidualSquares(initial.GetResidualSquares()) {
+    if (!(forgetting > 0.0 && forgetting <= 1.0)) {
+        throw std::invalid_argument("Forgetting factor must be in (0, 1]");
+    }
+    mScratch.resize(3 * mNumFeatures + mNumTargets);
+}
+
+/**
+ * Zeroes sqrt(weight) [x | y] against the diagonal of [R | d] with one
+ * Givens rotation per row of R; what is left of y is the new residual
+ * @param x n feature values
+ * @param y t target values
+ * @param weight Observation weight, after the existing state is scaled by the forgetting factor
+ * @throws std::invalid_argument if weight is negative
+ */
+void OnlineRegression::AddObservation(const double* x, const double* y, double weight) {
+    if (!(weight >= 0.0)) {
+        throw std::invalid_argument("Observation weight must be non-negative");
+    }
+    const int n = mNumFeatures;
+    const int t = mNumTargets;
+    double* R = mR.GetData();
+    const int ldr = mR.GetStride();
+    double* d = mRotatedTargets.GetData();
+    const int ldd = mRotatedTargets.GetStride();
+
+    if (mForgetting < 1.0) {
+        const double decay = std::sqrt(mForgetting);
+        for (int i = 0; i < n; i++) {
+            double* row = R + static_cast<std::size_t>(i) * ldr;
+            for (int j = i; j < n; j++) row[j] *= decay;
+            for (int k = 0; k < t; k++) d[static_cast<std::size_t>(i) * ldd + k] *= decay;
+        }
+        mResidualSquares *= mForgetting;
+        mTotalWeight *= mForgetting;
+    }
+
+    const double scale = std::sqrt(weight);
+    double* w = mScratch.data();
+    double* v = w + n;
+    for (int j = 0; j < n; j++) w[j] = scale * x[j];
+    for (int k = 0; k < t; k++) v[k] = scale * y[k];
+
+    for (int i = 0; i < n; i++) {
+        double* row = R + static_cast<std::size_t>(i) * ldr;
+        if (w[i] == 0.0) continue;
+        const double r = std::hypot(row[i], w[i]);
+        const double c = row[i] / r;
+        const double s = w[i] / r;
+        row[i] = r;
+        for (int j = i + 1; j < n; j++) {
+            const double rij = row[j];
+            row[j] = c * rij + s * w[j];
+            w[j] = c * w[j] - s * rij;
+        }
+        double* di = d + static_cast<std::size_t>(i) * ldd;
+        for (int k = 0; k < t; k++) {
+            const double dik = di[k];
+            di[k] = c * dik + s * v[k];
+            v[k] = c * v[k] - s * dik;
+        }
+    }
+    for (int k = 0; k < t; k++) mResidualSquares[k] += v[k] * v[k];
+    mTotalWeight += weight;
+}
+
+void OnlineRegression::AddObservation(const Vector& x, const Vector& y, double weight) {
+    if (x.GetSize() != mNumFeatures || y.GetSize() != mNumTargets) {
+        throw std::invalid_argument("Observation dimensions do not match the model");
+    }
+    AddObservation(x.GetData(), y.GetData(), weight);
+}
+
+/**
+ * LINPACK dchdd: solves R^T a = sqrt(weight) x, builds the rotations that
+ * turn [R; 0] into [R'; sqrt(weight) x^T] from a, and applies them to R
+ * and d. Fails before touching the state if ||a|| >= 1.
+ * @param x n feature values
+ * @param y t target values
+ * @param weight The observation's current weight
+ * @throws std::invalid_argument if weight is negative
+ * @throws std::runtime_error if the downdated factor would be singular or indefinite
+ */
+void OnlineRegression::RemoveObservation(const double* x, const double* y, double weight) {
+    if (!(weight >= 0.0)) {
+        throw std::invalid_argument("Observation weight must be non-negative");
+    }
+    const int n = mNumFeatures;
+    const int t = mNumTargets;
+    double* R = mR.GetData();
+    const int ldr = mR.GetStride();
+    double* d = mRotatedTargets.GetData();
+    const int ldd = mRotatedTargets.GetStride();
+    const double scale = std::sqrt(weight);
+    double* a = mScratch.data();
+    double* c = a + n;
+    double* s = c + n;
+
+    // R^T a = w, column i of R is row i of R^T
+    double normSquared = 0.0;
+    for (int i = 0; i < n; i++) {
+        double sum = scale * x[i];
+        for (int j = 0; j < i; j++) sum -= R[static_cast<std::size_t>(j) * ldr + i] * a[j];
+        const double rii = R[static_cast<std::size_t>(i) * ldr + i];
+        if (rii == 0.0) {
+            throw std::runtime_error("Cannot remove an observation from a singular factor");
+        }
+        a[i] = sum / rii;
+        normSquared += a[i] * a[i];
+    }
+    if (!(normSquared < 1.0)) {
+        throw std::runtime_error("Removing the observation would leave a singular system");
+    }
+
+    double alpha = std::sqrt(1.0 - normSquared);
+    for (int i = n - 1; i >= 0; i--) {
+        const double sc = alpha + std::fabs(a[i]);
+        const double p = alpha / sc;
+        const double q = a[i] / sc;
+        const double norm = std::sqrt(p * p + q * q);
+        c[i] = p / norm;
+        s[i] = q / norm;
+        alpha = sc * norm;
+    }
+    for (int j = 0; j < n; j++) {
+        double carry = 0.0;
+        for (int i = j; i >= 0; i--) {
+            double& rij = R[static_cast<std::size_t>(i) * ldr + j];
+            const double next = c[i] * carry + s[i] * rij;
+            rij = c[i] * rij - s[i] * carry;
+            carry = next;
+        }
+    }
+    for (int k = 0; k < t; k++) {
+        double zeta = scale * y[k];
+        for (int i = 0; i < n; i++) {
+            double& dik = d[static_cast<std::size_t>(i) * ldd + k];
+            dik = (dik - s[i] * zeta) / c[i];
+            zeta = c[i] * zeta - s[i] * dik;
+        }
+        mResidualSquares[k] = std::max(0.0, mResidualSquares[k] - zeta * zeta);
+    }
+    mTotalWeight -= weight;
+}
+
+void OnlineRegression::RemoveObservation(const Vector& x, const Vector& y, double weight) {
+    if (x.GetSize() != mNumFeatures || y.GetSize() != mNumTargets) {
+        throw std::invalid_argument("Observation dimensions do not match the model");
+    }
+    RemoveObservation(x.GetData(), y.GetData(), weight);
+}
+
+int OnlineRegression::GetNumFeatures() const { return mNumFeatures; }
+int OnlineRegression::GetNumTargets() const { return mNumTargets; }
+double OnlineRegression::GetForgetting() const { return mForgetting; }
+double OnlineRegression::GetTotalWeight() const { return mTotalWeight; }
+const Matrix& OnlineRegression::GetR() const { return mR; }
+const Vector& OnlineRegression::GetResidualSumOfSquares() const { return mResidualSquares; }
+
+/**
+ * Solves R b = d for every target
+ * @return n x t coefficients
+ * @throws std::runtime_error if a diagonal entry of R is negligible (n * eps * max |R_ii|)
+ */
+Matrix OnlineRegression::GetCoefficients() const {
+    const int n = mNumFeatures;
+    double maxDiagonal = 0.0;
+    for (int i = 1; i <= n; i++) maxDiagonal = std::max(maxDiagonal, std::fabs(mR(i, i)));
+    const double tolerance = n * std::numeric_limits<double>::epsilon() * maxDiagonal;
+    for (int i = 1; i <= n; i++) {
+        if (!(std::fabs(mR(i, i)) > tolerance)) {
+            throw std::runtime_error("Not enough observations to determine the coefficients");
+        }
+    }
+
+    Matrix coefficients(n, mNumTargets);
+    for (int k = 1; k <= mNumTargets; k++) {
+        for (int i = n; i >= 1; i--) {
+            double sum = mRotatedTargets(i, k);
+            for (int j = i + 1; j <= n; j++) sum -= mR(i, j) * coefficients(j, k);
+            coefficients(i, k) = sum / mR(i, i);
+        }
+    }
+    return coefficients;
+}
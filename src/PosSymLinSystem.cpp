@@ -1,4 +1,5 @@
 #include "PosSymLinSystem.h"
+#include "SymmetricEigenSolver.h"
 #include <cmath>
 #include <stdexcept>
 
@@ -8,88 +9,127 @@
  * @param b Vector of constants
  * @throws std::invalid_argument if A is not symmetric positive definite
  */
-PosSymLinSystem::PosSymLinSystem(const Matrix& A, const Vector& b) : LinearSystem(A, b) {
+PosSymLinSystem::PosSymLinSystem(const Matrix& A, const Vector& b) : LinearSystem(A, b), mpCholesky(nullptr) {
     if (!A.IsSymmetric()) {
         throw std::invalid_argument("Matrix must be symmetric for PosSymLinSystem");
     }
     
-    if (!isPositiveDefinite(A)) {
+    // The Cholesky factorization is the definiteness check: it breaks down on
+    // the first non-positive pivot. On success it is kept for every Solve.
+    CholeskyFactorization* cholesky = new CholeskyFactorization(A);
+    if (!cholesky->IsPositiveDefinite()) {
+        delete cholesky;
         throw std::invalid_argument("Matrix must be positive definite");
     }
+    mpCholesky = cholesky;
 }
 
-bool PosSymLinSystem::isPositiveDefinite(const Matrix& A) const {
-    // Using Sylvester's criterion: all leading principal minors should be positive
-    const int n = A.GetNumRows();
-    
-    for (int k = 1; k <= n; k++) {
-        Matrix submatrix(k, k);
-        for (int i = 1; i <= k; i++) {
-            for (int j = 1; j <= k; j++) {
-                submatrix(i, j) = A(i, j);
-            }
-        }
-        if (submatrix.Determinant() <= 0) {
-            return false;
-        }
-    }
-    return true;
+PosSymLinSystem::~PosSymLinSystem() {
+    delete mpCholesky;
 }
 
-bool PosSymLinSystem::isAllEigenvaluesPositive(const Matrix& A) const {
-    // Alternative method using Gershgorin circle theorem
-    const int n = A.GetNumRows();
-    for (int i = 1; i <= n; i++) {
-        double diagonal = A(i, i);
-        double sum = 0.0;
-        
-        for (int j = 1; j <= n; j++) {
-            if (i != j) {
-                sum += std::abs(A(i, j));
-            }
-        }
-        
-        // If any Gershgorin disk contains negative values, matrix is not positive definite
-        if (diagonal <= sum) {
-            return false;
-        }
-    }
-    return true;
+const CholeskyFactorization& PosSymLinSystem::GetCholesky() const {
+    return *mpCholesky;
+}
+
+/**
+ * Estimates the spectral condition number of A
+ * @return lambda_max / lambda_min from the extreme Lanczos Ritz values
+ */
+double PosSymLinSystem::EstimateConditionNumber() const {
+    return ::EstimateConditionNumber(*mpA);
+}
+
+/**
+ * Suggests the preconditioner for SolveConjugateGradient on this system
+ * @return Preconditioner type chosen from condition number estimates
+ */
+PreconditionerType PosSymLinSystem::RecommendPreconditioner() const {
+    return ::RecommendPreconditioner(*mpA);
+}
+
+/**
+ * Solves the linear system with the cached Cholesky factor
+ * @return Solution vector x
+ */
+Vector PosSymLinSystem::Solve() const {
+    return mpCholesky->Solve(*mpb);
+}
+
+/**
+ * Solves Ax = b for a new right-hand side with the cached Cholesky factor
+ * @param b Vector of constants
+ * @return Solution vector x
+ * @throws std::invalid_argument if b has the wrong size
+ */
+Vector PosSymLinSystem::Solve(const Vector& b) const {
+    return mpCholesky->Solve(b);
 }
 
-PosSymLinSystem::~PosSymLinSystem() {}
+/**
+ * Solves AX = B for several right-hand sides with the cached Cholesky factor
+ * @param B Matrix of constants
+ * @return Solution matrix X
+ * @throws std::invalid_argument if B has the wrong number of rows
+ */
+Matrix PosSymLinSystem::Solve(const Matrix& B) const {
+    return mpCholesky->Solve(B);
+}
 
 /**
  * Solves the linear system using Conjugate Gradient method
  * @return Solution vector x
  * @throws std::runtime_error if the method doesn't converge
  */
-Vector PosSymLinSystem::Solve() const {
-    const Matrix& A = *mpA;
-    const Vector& b = *mpb;
-    
-    Vector x(mSize); // Initial guess (all zeros)
-    Vector r = b - A * x;
-    Vector p = r;
+Vector PosSymLinSystem::SolveConjugateGradient() const {
+    ConjugateGradientOptions options;
+    options.relativeTolerance = 0.0;
+    options.absoluteTolerance = 1e-10;
+    options.maxIterations = mSize * 2;
     
-    double rsold = r * r;
-    const double tolerance = 1e-10;
-    const int maxIterations = mSize * 2;
-    
-    for (int i = 0; i < maxIterations; i++) {
-        Vector Ap = A * p;
-        double alpha = rsold / (p * Ap);
-        x = x + alpha * p;
-        r = r - alpha * Ap;
-        
-        double rsnew = r * r;
-        if (std::sqrt(rsnew) < tolerance) {
-            return x; // Convergence achieved
-        }
-        
-        p = r + (rsnew / rsold) * p;
-        rsold = rsnew;
+    ConjugateGradientResult result = ConjugateGradient(*mpA, *mpb, options);
+    if (!result.converged) {
+        throw std::runtime_error("Conjugate Gradient method did not converge");
     }
-    
-    throw std::runtime_error("Conjugate Gradient method did not converge");
-}
\ No newline at end of file
+    return result.solution;
+}
+
+/**
+ * Solves the linear system using the preconditioned Conjugate Gradient method
+ * @param options Tolerances, iteration cap and optional warm start
+ * @param preconditioner Preconditioner to build from A
+ * @param ssorOmega Relaxation factor when preconditioner is SSOR
+ * @return Solution with iteration count, residual and convergence flag
+ * @throws std::invalid_argument if the preconditioner cannot be built for A
+ */
+ConjugateGradientResult PosSymLinSystem::SolveConjugateGradient(const ConjugateGradientOptions& options,
+                                                                PreconditionerType preconditioner,
+                                                                double ssorOmega) const {
+    std::unique_ptr<Preconditioner> M = MakePreconditioner(preconditioner, *mpA, ssorOmega);
+    return ConjugateGradient(*mpA, *mpb, options, M.get());
+}
+
+/**
+ * Solves a sparse symmetric positive definite system with the preconditioned
+ * Conjugate Gradient method
+ * @param A Square symmetric sparse matrix
+ * @param b Vector of constants
+ * @param options Tolerances, iteration cap and optional warm start
+ * @param preconditioner Preconditioner to build from A
+ * @param ssorOmega Relaxation factor when preconditioner is SSOR
+ * @return Solution with iteration count, residual and convergence flag
+ * @throws std::invalid_argument if A is not symmetric or the dimensions don't match
+ */
+ConjugateGradientResult PosSymLinSystem::SolveConjugateGradient(const SparseMatrix& A, const Vector& b,
+                                                                const ConjugateGradientOptions& options,
+                                                                PreconditionerType preconditioner,
+                                                                double ssorOmega) {
+    if (!A.IsSymmetric()) {
+        throw std::invalid_argument("Matrix must be symmetric for PosSymLinSystem");
+    }
+    if (A.GetNumRows() != b.GetSize()) {
+        throw std::invalid_argument("Matrix A and vector b must have compatible dimensions");
+    }
+    std::unique_ptr<Preconditioner> M = MakePreconditioner(preconditioner, A, ssorOmega);
+    return ConjugateGradient(A, b, options, M.get());
+}
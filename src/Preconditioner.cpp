@@ -0,0 +1,378 @@
+#include "Preconditioner.h"
+#include "SymmetricEigenSolver.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+// First diagonal shift tried when IC(0) breaks down; doubled on each retry
+const double kInitialShift = 1e-3;
+const int kMaxShiftAttempts = 30;
+
+// Condition numbers CG handles in a few dozen iterations without help
+const double kWellConditioned = 1e2;
+// Patterns denser than this make IC(0) as costly as a full Cholesky
+const double kDensePatternFraction = 0.25;
+
+PreconditionerType Recommend(const LinearOperator& A, const Vector& diagonal, double density) {
+    const int n = A.GetNumRows();
+    if (EstimateConditionNumber(A) <= kWellConditioned) return PreconditionerType::None;
+
+    Vector invSqrtDiagonal(n);
+    for (int i = 0; i < n; i++) {
+        if (!(diagonal[i] > 0.0)) return PreconditionerType::None;   // Not SPD; nothing applies
+        invSqrtDiagonal[i] = 1.0 / std::sqrt(diagonal[i]);
+    }
+    Vector scaled(n);
+    FunctionOperator jacobiScaled(n, n, [&](const Vector& x, Vector& y) {
+        for (int i = 0; i < n; i++) scaled[i] = invSqrtDiagonal[i] * x[i];
+        A.Apply(scaled, y);
+        for (int i = 0; i < n; i++) y[i] *= invSqrtDiagonal[i];
+    });
+    if (EstimateConditionNumber(jacobiScaled) <= kWellConditioned) return PreconditionerType::Jacobi;
+
+    return density > kDensePatternFraction ? PreconditionerType::SSOR : PreconditionerType::IncompleteCholesky;
+}
+
+void CheckSquare(const Matrix& A) {
+    if (!A.IsSquare() || A.GetNumRows() == 0) {
+        throw std::invalid_argument("Preconditioner requires a non-empty square matrix");
+    }
+}
+
+void CheckSquare(const SparseMatrix& A) {
+    if (!A.IsSquare() || A.GetNumRows() == 0) {
+        throw std::invalid_argument("Preconditioner requires a non-empty square matrix");
+    }
+}
+
+void CheckSizes(int n, const Vector& r, const Vector& z) {
+    if (r.GetSize() != n || z.GetSize() != n) {
+        throw std::invalid_argument("Preconditioner and vector dimensions must match");
+    }
+}
+
+void CheckSizes(const Matrix& A, const Vector& r, const Vector& z) {
+    if (r.GetSize() != A.GetNumRows() || z.GetSize() != A.GetNumRows()) {
+        throw std::invalid_argument("Preconditioner and vector dimensions must match");
+    }
+}
+}
+
+Preconditioner::~Preconditioner() {}
+
+JacobiPreconditioner::JacobiPreconditioner(const Matrix& A) {
+    CheckSquare(A);
+    const int n = A.GetNumRows();
+    mInverseDiagonal = Vector(n);
+    for (int i = 0; i < n; i++) {
+        const double d = A.GetData()[static_cast<std::size_t>(i) * A.GetStride() + i];
+        if (!(d > 0.0)) {
+            throw std::invalid_argument("Jacobi preconditioner requires a positive diagonal");
+        }
+        mInverseDiagonal[i] = 1.0 / d;
+    }
+}
+
+JacobiPreconditioner::JacobiPreconditioner(const SparseMatrix& A) {
+    CheckSquare(A);
+    mInverseDiagonal = A.Diagonal();
+    for (int i = 0; i < mInverseDiagonal.GetSize(); i++) {
+        if (!(mInverseDiagonal[i] > 0.0)) {
+            throw std::invalid_argument("Jacobi preconditioner requires a positive diagonal");
+        }
+        mInverseDiagonal[i] = 1.0 / mInverseDiagonal[i];
+    }
+}
+
+JacobiPreconditioner::JacobiPreconditioner(const Vector& diagonal) : mInverseDiagonal(diagonal.GetSize()) {
+    for (int i = 0; i < diagonal.GetSize(); i++) {
+        if (!(diagonal[i] > 0.0)) {
+            throw std::invalid_argument("Jacobi preconditioner requires a positive diagonal");
+        }
+        mInverseDiagonal[i] = 1.0 / diagonal[i];
+    }
+}
+
+void JacobiPreconditioner::Apply(const Vector& r, Vector& z) const {
+    const int n = mInverseDiagonal.GetSize();
+    if (r.GetSize() != n || z.GetSize() != n) {
+        throw std::invalid_argument("Preconditioner and vector dimensions must match");
+    }
+    const double* inv = mInverseDiagonal.GetData();
+    const double* pr = r.GetData();
+    double* pz = z.GetData();
+    for (int i = 0; i < n; i++) pz[i] = inv[i] * pr[i];
+}
+
+SSORPreconditioner::SSORPreconditioner(const Matrix& A, double omega) : mA(A), mOmega(omega) {
+    CheckSquare(A);
+    if (!(omega > 0.0 && omega < 2.0)) {
+        throw std::invalid_argument("SSOR relaxation factor must be in (0, 2)");
+    }
+    for (int i = 0; i < A.GetNumRows(); i++) {
+        if (!(A.GetData()[static_cast<std::size_t>(i) * A.GetStride() + i] > 0.0)) {
+            throw std::invalid_argument("SSOR preconditioner requires a positive diagonal");
+        }
+    }
+}
+
+void SSORPreconditioner::Apply(const Vector& r, Vector& z) const {
+    CheckSizes(mA, r, z);
+    const int n = mA.GetNumRows();
+    const double* a = mA.GetData();
+    const int lda = mA.GetStride();
+    const double* pr = r.GetData();
+    double* pz = z.GetData();
+
+    // Forward sweep: (D + wL) y = r, then y <- D y
+    for (int i = 0; i < n; i++) {
+        const double* row = a + static_cast<std::size_t>(i) * lda;
+        double sum = 0.0;
+        for (int j = 0; j < i; j++) sum += row[j] * pz[j];
+        pz[i] = (pr[i] - mOmega * sum) / row[i];
+    }
+    for (int i = 0; i < n; i++) pz[i] *= a[static_cast<std::size_t>(i) * lda + i];
+
+    // Backward sweep: (D + wL^T) z = y, using the symmetry of A
+    const double scale = mOmega * (2.0 - mOmega);
+    for (int i = n - 1; i >= 0; i--) {
+        const double* row = a + static_cast<std::size_t>(i) * lda;
+        double sum = 0.0;
+        for (int j = i + 1; j < n; j++) sum += row[j] * pz[j];
+        pz[i] = (pz[i] - mOmega * sum) / row[i];
+    }
+    for (int i = 0; i < n; i++) pz[i] *= scale;
+}
+
+IncompleteCholeskyPreconditioner::IncompleteCholeskyPreconditioner(const Matrix& A) : mShift(0.0) {
+    CheckSquare(A);
+    double shift = 0.0;
+    for (int attempt = 0; attempt < kMaxShiftAttempts; attempt++) {
+        if (TryFactorize(A, shift)) {
+            mShift = shift;
+            return;
+        }
+        shift = (shift == 0.0) ? kInitialShift : 2.0 * shift;
+    }
+    throw std::runtime_error("Incomplete Cholesky factorization failed");
+}
+
+// IC(0) on the lower triangle of A + shift * diag(A); false on pivot breakdown
+bool IncompleteCholeskyPreconditioner::TryFactorize(const Matrix& A, double shift) {
+    const int n = A.GetNumRows();
+    const double* a = A.GetData();
+    const int lda = A.GetStride();
+    mL = Matrix(n, n);
+    double* l = mL.GetData();
+    const int ldl = mL.GetStride();
+
+    for (int i = 0; i < n; i++) {
+        const double* rowA = a + static_cast<std::size_t>(i) * lda;
+        double* rowL = l + static_cast<std::size_t>(i) * ldl;
+        for (int k = 0; k < i; k++) {
+            if (rowA[k] == 0.0) continue;   // Outside the pattern: no fill-in
+            const double* rowK = l + static_cast<std::size_t>(k) * ldl;
+            double sum = rowA[k];
+            for (int j = 0; j < k; j++) sum -= rowL[j] * rowK[j];
+            rowL[k] = sum / rowK[k];
+        }
+        double d = rowA[i] * (1.0 + shift);
+        for (int j = 0; j < i; j++) d -= rowL[j] * rowL[j];
+        if (!(d > 0.0)) return false;
+        rowL[i] = std::sqrt(d);
+    }
+    return true;
+}
+
+void IncompleteCholeskyPreconditioner::Apply(const Vector& r, Vector& z) const {
+    CheckSizes(mL, r, z);
+    const int n = mL.GetNumRows();
+    const double* l = mL.GetData();
+    const int ldl = mL.GetStride();
+    const double* pr = r.GetData();
+    double* pz = z.GetData();
+
+    for (int i = 0; i < n; i++) {
+        const double* row = l + static_cast<std::size_t>(i) * ldl;
+        double sum = pr[i];
+        for (int j = 0; j < i; j++) sum -= row[j] * pz[j];
+        pz[i] = sum / row[i];
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        const double* row = l + static_cast<std::size_t>(i) * ldl;
+        pz[i] /= row[i];
+        const double zi = pz[i];
+        for (int j = 0; j < i; j++) pz[j] -= row[j] * zi;
+    }
+}
+
+double IncompleteCholeskyPreconditioner::GetShift() const { return mShift; }
+
+SparseSSORPreconditioner::SparseSSORPreconditioner(const SparseMatrix& A, double omega)
+    : mA(A), mDiagonal(A.GetNumRows()), mOmega(omega) {
+    CheckSquare(A);
+    if (!(omega > 0.0 && omega < 2.0)) {
+        throw std::invalid_argument("SSOR relaxation factor must be in (0, 2)");
+    }
+    mDiagonal = A.Diagonal();
+    for (int i = 0; i < A.GetNumRows(); i++) {
+        if (!(mDiagonal[i] > 0.0)) {
+            throw std::invalid_argument("SSOR preconditioner requires a positive diagonal");
+        }
+    }
+}
+
+// Same sweeps as SSORPreconditioner::Apply, visiting only the stored entries
+void SparseSSORPreconditioner::Apply(const Vector& r, Vector& z) const {
+    const int n = mA.GetNumRows();
+    CheckSizes(n, r, z);
+    const int* rowPtr = mA.GetRowPointers().data();
+    const int* col = mA.GetColumnIndices().data();
+    const double* val = mA.GetValues().data();
+    const double* d = mDiagonal.GetData();
+    const double* pr = r.GetData();
+    double* pz = z.GetData();
+
+    for (int i = 0; i < n; i++) {
+        double sum = 0.0;
+        for (int k = rowPtr[i]; k < rowPtr[i + 1] && col[k] < i; k++) sum += val[k] * pz[col[k]];
+        pz[i] = (pr[i] - mOmega * sum) / d[i];
+    }
+    for (int i = 0; i < n; i++) pz[i] *= d[i];
+
+    const double scale = mOmega * (2.0 - mOmega);
+    for (int i = n - 1; i >= 0; i--) {
+        double sum = 0.0;
+        for (int k = rowPtr[i + 1] - 1; k >= rowPtr[i] && col[k] > i; k--) sum += val[k] * pz[col[k]];
+        pz[i] = (pz[i] - mOmega * sum) / d[i];
+    }
+    for (int i = 0; i < n; i++) pz[i] *= scale;
+}
+
+SparseIncompleteCholeskyPreconditioner::SparseIncompleteCholeskyPreconditioner(const SparseMatrix& A)
+    : mShift(0.0) {
+    CheckSquare(A);
+    double shift = 0.0;
+    for (int attempt = 0; attempt < kMaxShiftAttempts; attempt++) {
+        if (TryFactorize(A, shift)) {
+            mShift = shift;
+            return;
+        }
+        shift = (shift == 0.0) ? kInitialShift : 2.0 * shift;
+    }
+    throw std::runtime_error("Incomplete Cholesky factorization failed");
+}
+
+// Row-by-row IC(0): row i of L is scattered into a dense work row so that
+// each L(i,k) costs one pass over the stored entries of row k
+bool SparseIncompleteCholeskyPreconditioner::TryFactorize(const SparseMatrix& A, double shift) {
+    const int n = A.GetNumRows();
+    const int* rowPtrA = A.GetRowPointers().data();
+    const int* colA = A.GetColumnIndices().data();
+    const double* valA = A.GetValues().data();
+
+    mRowPointers.assign(1, 0);
+    mColumnIndices.clear();
+    mValues.clear();
+    std::vector<double> work(n, 0.0);
+
+    for (int i = 0; i < n; i++) {
+        const int rowStart = static_cast<int>(mValues.size());
+        double d = 0.0;
+        for (int k = rowPtrA[i]; k < rowPtrA[i + 1] && colA[k] <= i; k++) {
+            const int c = colA[k];
+            if (c == i) {
+                d = valA[k] * (1.0 + shift);
+                break;
+            }
+            double sum = valA[k];
+            for (int m = mRowPointers[c]; m < mRowPointers[c + 1] - 1; m++) {
+                sum -= mValues[m] * work[mColumnIndices[m]];
+            }
+            const double lik = sum / mValues[mRowPointers[c + 1] - 1];
+            work[c] = lik;
+            mColumnIndices.push_back(c);
+            mValues.push_back(lik);
+        }
+        for (int m = rowStart; m < static_cast<int>(mValues.size()); m++) {
+            d -= mValues[m] * mValues[m];
+            work[mColumnIndices[m]] = 0.0;
+        }
+        if (!(d > 0.0)) return false;
+        mColumnIndices.push_back(i);
+        mValues.push_back(std::sqrt(d));
+        mRowPointers.push_back(static_cast<int>(mValues.size()));
+    }
+    return true;
+}
+
+void SparseIncompleteCholeskyPreconditioner::Apply(const Vector& r, Vector& z) const {
+    const int n = static_cast<int>(mRowPointers.size()) - 1;
+    CheckSizes(n, r, z);
+    const double* pr = r.GetData();
+    double* pz = z.GetData();
+
+    for (int i = 0; i < n; i++) {
+        const int diag = mRowPointers[i + 1] - 1;
+        double sum = pr[i];
+        for (int k = mRowPointers[i]; k < diag; k++) sum -= mValues[k] * pz[mColumnIndices[k]];
+        pz[i] = sum / mValues[diag];
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        const int diag = mRowPointers[i + 1] - 1;
+        pz[i] /= mValues[diag];
+        const double zi = pz[i];
+        for (int k = mRowPointers[i]; k < diag; k++) pz[mColumnIndices[k]] -= mValues[k] * zi;
+    }
+}
+
+double SparseIncompleteCholeskyPreconditioner::GetShift() const { return mShift; }
+
+std::unique_ptr<Preconditioner> MakePreconditioner(PreconditionerType type, const Matrix& A,
+                                                   double ssorOmega) {
+    switch (type) {
+        case PreconditionerType::Jacobi:
+            return std::unique_ptr<Preconditioner>(new JacobiPreconditioner(A));
+        case PreconditionerType::SSOR:
+            return std::unique_ptr<Preconditioner>(new SSORPreconditioner(A, ssorOmega));
+        case PreconditionerType::IncompleteCholesky:
+            return std::unique_ptr<Preconditioner>(new IncompleteCholeskyPreconditioner(A));
+        case PreconditionerType::None:
+        default:
+            return std::unique_ptr<Preconditioner>();
+    }
+}
+
+std::unique_ptr<Preconditioner> MakePreconditioner(PreconditionerType type, const SparseMatrix& A,
+                                                   double ssorOmega) {
+    switch (type) {
+        case PreconditionerType::Jacobi:
+            return std::unique_ptr<Preconditioner>(new JacobiPreconditioner(A));
+        case PreconditionerType::SSOR:
+            return std::unique_ptr<Preconditioner>(new SparseSSORPreconditioner(A, ssorOmega));
+        case PreconditionerType::IncompleteCholesky:
+            return std::unique_ptr<Preconditioner>(new SparseIncompleteCholeskyPreconditioner(A));
+        case PreconditionerType::None:
+        default:
+            return std::unique_ptr<Preconditioner>();
+    }
+}
+
+PreconditionerType RecommendPreconditioner(const Matrix& A) {
+    CheckSquare(A);
+    const int n = A.GetNumRows();
+    Vector diagonal(n);
+    long nonZeros = 0;
+    for (int i = 0; i < n; i++) {
+        const double* row = A.GetData() + static_cast<std::size_t>(i) * A.GetStride();
+        diagonal[i] = row[i];
+        for (int j = 0; j < n; j++) nonZeros += (row[j] != 0.0);
+    }
+    return Recommend(A, diagonal, static_cast<double>(nonZeros) / (static_cast<double>(n) * n));
+}
+
+PreconditionerType RecommendPreconditioner(const SparseMatrix& A) {
+    CheckSquare(A);
+    const double n = A.GetNumRows();
+    return Recommend(A, A.Diagonal(), A.GetNumNonZeros() / (n * n));
+}
@@ -0,0 +1,345 @@
+#include "QRFactorization.h"
+#include "Gemm.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+// Columns per panel of the blocked factorization
+const int kPanelWidth = 32;
+
+// Right-hand-side columns per parallel task in the triangular solve
+const int kColumnGrain = 32;
+}
+
+/**
+ * Factorizes A
+ * @param A Matrix with at least as many rows as columns
+ * @throws std::invalid_argument if A has fewer rows than columns
+ */
+QRFactorization::QRFactorization(const Matrix& A)
+    : mNumRows(A.GetNumRows()), mNumCols(A.GetNumCols()), mQR(A), mTau(A.GetNumCols(), 0.0) {
+    if (mNumRows < mNumCols) {
+        throw std::invalid_argument("QR factorization requires at least as many rows as columns");
+    }
+    Factorize();
+}
+
+int QRFactorization::GetNumRows() const { return mNumRows; }
+int QRFactorization::GetNumCols() const { return mNumCols; }
+
+void QRFactorization::Factorize() {
+    const int m = mNumRows;
+    const int n = mNumCols;
+    double* a = mQR.GetData();
+    const int lda = mQR.GetStride();
+    std::vector<double> w(kPanelWidth);
+
+    for (int j0 = 0; j0 < n; j0 += kPanelWidth) {
+        const int j1 = std::min(n, j0 + kPanelWidth);
+
+        // Unblocked Householder QR of the panel A[j0:m, j0:j1]
+        for (int j = j0; j < j1; j++) {
+            double* rowJ = a + static_cast<std::size_t>(j) * lda;
+            double scale = 0.0;
+            for (int i = j + 1; i < m; i++) {
+                scale = std::max(scale, std::abs(a[static_cast<std::size_t>(i) * lda + j]));
+            }
+            if (scale == 0.0) {
+                mTau[j] = 0.0;   // Already zero below the diagonal: H = I
+                continue;
+            }
+            // Scaled norm so that badly scaled columns cannot overflow
+            double sumSq = 0.0;
+            for (int i = j + 1; i < m; i++) {
+                const double t = a[static_cast<std::size_t>(i) * lda + j] / scale;
+                sumSq += t * t;
+            }
+            const double alpha = rowJ[j];
+            const double tailNorm = scale * std::sqrt(sumSq);
+            const double beta = (alpha >= 0.0 ? -1.0 : 1.0) * std::hypot(alpha, tailNorm);
+            mTau[j] = (beta - alpha) / beta;
+            const double inv = 1.0 / (alpha - beta);
+            for (int i = j + 1; i < m; i++) a[static_cast<std::size_t>(i) * lda + j] *= inv;
+            rowJ[j] = beta;
+
+            // H_j applied to the rest of the panel: c -= tau * v (v^T c)
+            const int nc = j1 - j - 1;
+            if (nc == 0) continue;
+            for (int c = 0; c < nc; c++) w[c] = rowJ[j + 1 + c];
+            for (int i = j + 1; i < m; i++) {
+                const double* rowI = a + static_cast<std::size_t>(i) * lda;
+                const double vi = rowI[j];
+                for (int c = 0; c < nc; c++) w[c] += vi * rowI[j + 1 + c];
+            }
+            for (int c = 0; c < nc; c++) w[c] *= mTau[j];
+            for (int c = 0; c < nc; c++) rowJ[j + 1 + c] -= w[c];
+            for (int i = j + 1; i < m; i++) {
+                double* rowI = a + static_cast<std::size_t>(i) * lda;
+                const double vi = rowI[j];
+                for (int c = 0; c < nc; c++) rowI[j + 1 + c] -= vi * w[c];
+            }
+        }
+
+        // T of the compact WY form: T(0:i, i) = -tau_i T(0:i, 0:i) V^T v_i
+        const int nb = j1 - j0;
+        mV.push_back(PanelReflectors(j0, j1));
+        const Matrix& V = mV.back();
+        Matrix VtV(nb, nb);
+        Gemm(true, false, nb, nb, m - j0, 1.0, V.GetData(), V.GetStride(),
+             V.GetData(), V.GetStride(), 0.0, VtV.GetData(), VtV.GetStride());
+        Matrix T(nb, nb);
+        double* t = T.GetData();
+        const int ldt = T.GetStride();
+        for (int i = 0; i < nb; i++) {
+            const double tau = mTau[j0 + i];
+            for (int r = 0; r < i; r++) {
+                double sum = 0.0;
+                for (int c = r; c < i; c++) {
+                    sum += t[static_cast<std::size_t>(r) * ldt + c] * VtV.GetData()[static_cast<std::size_t>(c) * VtV.GetStride() + i];
+                }
+                t[static_cast<std::size_t>(r) * ldt + i] = -tau * sum;
+            }
+            t[static_cast<std::size_t>(i) * ldt + i] = tau;
+        }
+        mT.push_back(std::move(T));
+
+        if (j1 < n) {
+            ApplyPanel(static_cast<int>(mT.size()) - 1, true,
+                       a + static_cast<std::size_t>(j0) * lda + j1, lda, n - j1);
+        }
+    }
+}
+
+// Explicit V of the panel [j0, j1): rows j0..m-1, unit diagonal, zeros above
+Matrix QRFactorization::PanelReflectors(int j0, int j1) const {
+    const int mr = mNumRows - j0;
+    const int nb = j1 - j0;
+    Matrix V(mr, nb);
+    double* v = V.GetData();
+    const int ldv = V.GetStride();
+    const double* a = mQR.GetData();
+    const int lda = mQR.GetStride();
+    for (int i = 0; i < mr; i++) {
+        const double* rowA = a + static_cast<std::size_t>(j0 + i) * lda + j0;
+        double* rowV = v + static_cast<std::size_t>(i) * ldv;
+        for (int c = 0; c < nb; c++) {
+            rowV[c] = (i > c) ? rowA[c] : (i == c ? 1.0 : 0.0);
+        }
+    }
+    return V;
+}
+
+// C <- (I - V T V^T) C, or with T^T when transpose is set. C holds rows
+// j0..m-1 of the operand for the panel starting at column j0.
+void QRFactorization::ApplyPanel(int panel, bool transpose, double* c, int ldc, int numCols) const {
+    const int j0 = panel * kPanelWidth;
+    const int nb = std::min(mNumCols, j0 + kPanelWidth) - j0;
+    const int mr = mNumRows - j0;
+    const Matrix& V = mV[panel];
+    const Matrix& T = mT[panel];
+
+    Matrix W(nb, numCols);
+    Gemm(true, false, nb, numCols, mr, 1.0, V.GetData(), V.GetStride(),
+         c, ldc, 0.0, W.GetData(), W.GetStride());
+    Matrix TW(nb, numCols);
+    Gemm(transpose, false, nb, numCols, nb, 1.0, T.GetData(), T.GetStride(),
+         W.GetData(), W.GetStride(), 0.0, TW.GetData(), TW.GetStride());
+    Gemm(false, false, mr, numCols, nb, -1.0, V.GetData(), V.GetStride(),
+         TW.GetData(), TW.GetStride(), 1.0, c, ldc);
+}
+
+Matrix QRFactorization::GetR() const {
+    Matrix R(mNumCols, mNumCols);
+    for (int i = 0; i < mNumCols; i++) {
+        const double* rowQR = mQR.GetData() + static_cast<std::size_t>(i) * mQR.GetStride();
+        double* rowR = R.GetData() + static_cast<std::size_t>(i) * R.GetStride();
+        for (int j = i; j < mNumCols; j++) rowR[j] = rowQR[j];
+    }
+    return R;
+}
+
+Matrix QRFactorization::GetQ() const {
+    Matrix Q(mNumRows, mNumCols);
+    for (int i = 0; i < mNumCols; i++) {
+        Q.GetData()[static_cast<std::size_t>(i) * Q.GetStride() + i] = 1.0;
+    }
+    ApplyQ(Q);
+    return Q;
+}
+
+int QRFactorization::GetRank() const {
+    double largest = 0.0;
+    for (int i = 0; i < mNumCols; i++) {
+        largest = std::max(largest, std::abs(mQR.GetData()[static_cast<std::size_t>(i) * mQR.GetStride() + i]));
+    }
+    const double tolerance = mNumRows * std::numeric_limits<double>::epsilon() * largest;
+    int rank = 0;
+    for (int i = 0; i < mNumCols; i++) {
+        if (std::abs(mQR.GetData()[static_cast<std::size_t>(i) * mQR.GetStride() + i]) > tolerance) rank++;
+    }
+    return rank;
+}
+
+bool QRFactorization::IsFullRank() const {
+    return mNumCols > 0 && GetRank() == mNumCols;
+}
+
+/**
+ * Overwrites B with Q^T B, one panel at a time
+ * @param B Matrix with m rows
+ * @throws std::invalid_argument if B has the wrong number of rows
+ */
+void QRFactorization::ApplyQTranspose(Matrix& B) const {
+    if (B.GetNumRows() != mNumRows) {
+        throw std::invalid_argument("Right-hand side size does not match the factorized matrix");
+    }
+    for (int panel = 0; panel < static_cast<int>(mT.size()); panel++) {
+        const int j0 = panel * kPanelWidth;
+        ApplyPanel(panel, true, B.GetData() + static_cast<std::size_t>(j0) * B.GetStride(),
+                   B.GetStride(), B.GetNumCols());
+    }
+}
+
+/**
+ * Overwrites B with Q B, last panel first
+ * @param B Matrix with m rows
+ * @throws std::invalid_argument if B has the wrong number of rows
+ */
+void QRFactorization::ApplyQ(Matrix& B) const {
+    if (B.GetNumRows() != mNumRows) {
+        throw std::invalid_argument("Right-hand side size does not match the factorized matrix");
+    }
+    for (int panel = static_cast<int>(mT.size()) - 1; panel >= 0; panel--) {
+        const int j0 = panel * kPanelWidth;
+        ApplyPanel(panel, false, B.GetData() + static_cast<std::size_t>(j0) * B.GetStride(),
+                   B.GetStride(), B.GetNumCols());
+    }
+}
+
+/**
+ * Overwrites b with Q^T b using the stored reflectors directly
+ * @param b Vector with m entries
+ * @throws std::invalid_argument if b has the wrong size
+ */
+void QRFactorization::ApplyQTranspose(Vector& b) const {
+    if (b.GetSize() != mNumRows) {
+        throw std::invalid_argument("Right-hand side size does not match the factorized matrix");
+    }
+    const double* a = mQR.GetData();
+    const int lda = mQR.GetStride();
+    double* pb = b.GetData();
+    for (int j = 0; j < mNumCols; j++) {
+        if (mTau[j] == 0.0) continue;
+        double dot = pb[j];
+        for (int i = j + 1; i < mNumRows; i++) dot += a[static_cast<std::size_t>(i) * lda + j] * pb[i];
+        dot *= mTau[j];
+        pb[j] -= dot;
+        for (int i = j + 1; i < mNumRows; i++) pb[i] -= a[static_cast<std::size_t>(i) * lda + j] * dot;
+    }
+}
+
+void QRFactorization::CheckSolvable(int rhsRows) const {
+    if (mNumCols == 0) {
+        throw std::runtime_error("QR factorization is empty");
+    }
+    if (rhsRows != mNumRows) {
+        throw std::invalid_argument("Right-hand side size does not match the factorized matrix");
+    }
+    if (!IsFullRank()) {
+        throw std::runtime_error("Matrix is rank deficient");
+    }
+}
+
+/**
+ * Solves min ||Ax - b|| as R x = (Q^T b)[0:n]
+ * @param b Right-hand side with m entries
+ * @return Least-squares solution x
+ * @throws std::runtime_error if A is rank deficient
+ */
+Vector QRFactorization::Solve(const Vector& b) const {
+    CheckSolvable(b.GetSize());
+    Vector qtb(b);
+    ApplyQTranspose(qtb);
+
+    const int n = mNumCols;
+    const double* r = mQR.GetData();
+    const int ldr = mQR.GetStride();
+    Vector x(n);
+    for (int i = n - 1; i >= 0; i--) {
+        const double* row = r + static_cast<std::size_t>(i) * ldr;
+        double sum = qtb[i];
+        for (int j = i + 1; j < n; j++) sum -= row[j] * x[j];
+        x[i] = sum / row[i];
+    }
+    return x;
+}
+
+/**
+ * Solves min ||AX - B|| for every column of B
+ * @param B Right-hand sides with m rows, one per column
+ * @return Least-squares solution X (n x columns of B)
+ * @throws std::runtime_error if A is rank deficient
+ */
+Matrix QRFactorization::Solve(const Matrix& B) const {
+    CheckSolvable(B.GetNumRows());
+    Matrix QtB(B);
+    ApplyQTranspose(QtB);
+    return BackSubstitute(QtB);
+}
+
+/**
+ * Forms the pseudo-inverse from the thin Q, for callers that need it explicitly
+ * @return R^-1 Q^T
+ * @throws std::runtime_error if A is rank deficient
+ */
+Matrix QRFactorization::PseudoInverse() const {
+    CheckSolvable(mNumRows);
+    return BackSubstitute(GetQ().Transpose());
+}
+
+// Solves R X = QtB[0:n] for every column of QtB
+Matrix QRFactorization::BackSubstitute(const Matrix& QtB) const {
+    const int n = mNumCols;
+    const int nrhs = QtB.GetNumCols();
+    Matrix X(n, nrhs);
+    double* x = X.GetData();
+    const int ldx = X.GetStride();
+    for (int i = 0; i < n; i++) {
+        std::copy(QtB.GetData() + static_cast<std::size_t>(i) * QtB.GetStride(),
+                  QtB.GetData() + static_cast<std::size_t>(i) * QtB.GetStride() + nrhs,
+                  x + static_cast<std::size_t>(i) * ldx);
+    }
+
+    // Back substitution with R, bottom block row first
+    const double* r = mQR.GetData();
+    const int ldr = mQR.GetStride();
+    ThreadPool& pool = ThreadPool::Global();
+    for (int k1 = n; k1 > 0; ) {
+        const int k0 = std::max(0, k1 - kPanelWidth);
+        pool.ParallelFor(0, nrhs, kColumnGrain, [&](int first, int last) {
+            for (int i = k1 - 1; i >= k0; i--) {
+                const double* rowR = r + static_cast<std::size_t>(i) * ldr;
+                double* rowI = x + static_cast<std::size_t>(i) * ldx;
+                for (int p = i + 1; p < k1; p++) {
+                    const double* rowP = x + static_cast<std::size_t>(p) * ldx;
+                    for (int j = first; j < last; j++) rowI[j] -= rowR[p] * rowP[j];
+                }
+                const double inv = 1.0 / rowR[i];
+                for (int j = first; j < last; j++) rowI[j] *= inv;
+            }
+        });
+        if (k0 > 0) {
+            // X[0:k0] -= R[0:k0, k0:k1] * X[k0:k1]
+            Gemm(false, false, k0, nrhs, k1 - k0,
+                 -1.0, r + k0, ldr,
+                 x + static_cast<std::size_t>(k0) * ldx, ldx,
+                 1.0, x, ldx);
+        }
+        k1 = k0;
+    }
+    return X;
+}
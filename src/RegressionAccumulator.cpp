@@ -0,0 +1,357 @@
+#include "RegressionAccumulator.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// Rows packed per block of the Householder kernel; a block of 128 rows with
+// a few dozen columns stays in L1/L2 while every reflector is applied
+const int kRowBlock = 128;
+
+// A batch is split into at most kMaxShards shards of at least kMinShardRows
+// rows; each shard keeps its own factor
+const int kMinShardRows = 8192;
+const int kMaxShards = 64;
+
+// Four independent sums so the additions pipeline
+inline double Dot(const double* a, const double* b, int count) {
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    int k = 0;
+    for (; k + 4 <= count; k += 4) {
+        s0 += a[k] * b[k];
+        s1 += a[k + 1] * b[k + 1];
+        s2 += a[k + 2] * b[k + 2];
+        s3 += a[k + 3] * b[k + 3];
+    }
+    for (; k < count; k++) s0 += a[k] * b[k];
+    return (s0 + s1) + (s2 + s3);
+}
+
+/**
+ * Absorbs rows [first, last) of [X | Y] into the factor [R | d] (n x n and
+ * n x t) and adds what is left of each target to squares. Each block of
+ * rows is packed transposed so that every feature and target is a
+ * contiguous run; column j of the block is then zeroed against R_jj by one
+ * Householder reflection, which is applied to the rest of the block and of
+ * row j of [R | d]. The diagonal of R stays non-negative.
+ */
+void AbsorbRows(const double* X, int ldx, const double* Y, int ldy, int first, int last, int n, int t,
+                double* R, int ldr, double* d, int ldd, double* squares) {
+    std::vector<double> panel(static_cast<std::size_t>(n + t) * kRowBlock);
+    for (int r0 = first; r0 < last; r0 += kRowBlock) {
+        const int rb = std::min(kRowBlock, last - r0);
+        for (int r = 0; r < rb; r++) {
+            const double* x = X + static_cast<std::size_t>(r0 + r) * ldx;
+            const double* y = Y + static_cast<std::size_t>(r0 + r) * ldy;
+            for (int j = 0; j < n; j++) panel[j * kRowBlock + r] = x[j];
+            for (int s = 0; s < t; s++) panel[(n + s) * kRowBlock + r] = y[s];
+        }
+        for (int j = 0; j < n; j++) {
+            double* pj = panel.data() + j * kRowBlock;
+            const double sigma = Dot(pj, pj, rb);
+            if (sigma == 0.0) continue;
+            double* rj = R + static_cast<std::size_t>(j) * ldr;
+            double* dj = d + static_cast<std::size_t>(j) * ldd;
+            // v = [R_jj - norm; p_j] maps [R_jj; p_j] to [norm; 0]; the first
+            // entry is formed without cancellation, then v is scaled to v_0 = 1
+            const double alpha = rj[j];
+            const double norm = std::sqrt(alpha * alpha + sigma);
+            const double v0 = alpha <= 0.0 ? alpha - norm : -sigma / (alpha + norm);
+            const double tau = 2.0 * v0 * v0 / (sigma + v0 * v0);
+            for (int r = 0; r < rb; r++) pj[r] /= v0;
+            rj[j] = norm;
+            for (int c = j + 1; c < n + t; c++) {
+                double* pc = panel.data() + c * kRowBlock;
+                double& head = c < n ? rj[c] : dj[c - n];
+                const double w = tau * (head + Dot(pj, pc, rb));
+                head -= w;
+                for (int r = 0; r < rb; r++) pc[r] -= w * pj[r];
+            }
+        }
+        for (int s = 0; s < t; s++) {
+            const double* ys = panel.data() + (n + s) * kRowBlock;
+            squares[s] += Dot(ys, ys, rb);
+        }
+    }
+}
+
+/**
+ * LINPACK dchdd: removes the row [x | y] from [R | d], as
+ * OnlineRegression::RemoveObservation does, and adds the part of each
+ * target that was not explained by x to removed
+ * @param work 3n doubles
+ * @throws std::runtime_error if the downdated factor would be singular
+ */
+void DowndateRow(double* R, int ldr, double* d, int ldd, const double* x, const double* y, int n, int t,
+                 double* work, double* removed) {
+    double* a = work;
+    double* c = a + n;
+    double* s = c + n;
+
+    // R^T a = x, column i of R is row i of R^T
+    double normSquared = 0.0;
+    for (int i = 0; i < n; i++) {
+        double sum = x[i];
+        for (int j = 0; j < i; j++) sum -= R[static_cast<std::size_t>(j) * ldr + i] * a[j];
+        const double rii = R[static_cast<std::size_t>(i) * ldr + i];
+        if (rii == 0.0) {
+            throw std::runtime_error("Cannot remove rows from a singular factor");
+        }
+        a[i] = sum / rii;
+        normSquared += a[i] * a[i];
+    }
+    if (!(normSquared < 1.0)) {
+        throw std::runtime_error("Removing the rows would leave a singular system");
+    }
+
+    double alpha = std::sqrt(1.0 - normSquared);
+    for (int i = n - 1; i >= 0; i--) {
+        const double sc = alpha + std::fabs(a[i]);
+        const double p = alpha / sc;
+        const double q = a[i] / sc;
+        const double norm = std::sqrt(p * p + q * q);
+        c[i] = p / norm;
+        s[i] = q / norm;
+        alpha = sc * norm;
+    }
+    for (int j = 0; j < n; j++) {
+        double carry = 0.0;
+        for (int i = j; i >= 0; i--) {
+            double& rij = R[static_cast<std::size_t>(i) * ldr + j];
+            const double next = c[i] * carry + s[i] * rij;
+            rij = c[i] * rij - s[i] * carry;
+            carry = next;
+        }
+    }
+    for (int k = 0; k < t; k++) {
+        double zeta = y[k];
+        for (int i = 0; i < n; i++) {
+            double& dik = d[static_cast<std::size_t>(i) * ldd + k];
+            dik = (dik - s[i] * zeta) / c[i];
+            zeta = c[i] * zeta - s[i] * dik;
+        }
+        removed[k] += zeta * zeta;
+    }
+}
+}
+
+RegressionAccumulator::RegressionAccumulator(int numFeatures, int numTargets)
+    : mNumFeatures(numFeatures), mNumTargets(numTargets), mNumRows(0) {
+    if (numFeatures <= 0 || numTargets <= 0) {
+        throw std::invalid_argument("Feature and target counts must be positive");
+    }
+    mR = Matrix(numFeatures, numFeatures);
+    mRotatedTargets = Matrix(numFeatures, numTargets);
+    mResidualSquares = Vector(numTargets);
+}
+
+/**
+ * Folds a batch of rows into the factor
+ * @param numRows Rows in the batch (0 is allowed)
+ * @param X First row of the features, n values per row
+ * @param ldx Distance between rows of X
+ * @param Y First row of the targets, t values per row
+ * @param ldy Distance between rows of Y
+ * @throws std::invalid_argument if numRows is negative
+ */
+void RegressionAccumulator::AddRows(int numRows, const double* X, int ldx, const double* Y, int ldy) {
+    if (numRows < 0) {
+        throw std::invalid_argument("Row count must be non-negative");
+    }
+    if (numRows == 0) return;
+    const int n = mNumFeatures;
+    const int t = mNumTargets;
+    double* R = mR.GetData();
+    double* d = mRotatedTargets.GetData();
+    double* squares = mResidualSquares.GetData();
+    const int numShards = std::max(1, std::min(kMaxShards, numRows / kMinShardRows));
+    if (numShards == 1) {
+        AbsorbRows(X, ldx, Y, ldy, 0, numRows, n, t, R, mR.GetStride(), d, mRotatedTargets.GetStride(), squares);
+        mNumRows += numRows;
+        return;
+    }
+
+    const std::size_t partialSize = static_cast<std::size_t>(n) * n + static_cast<std::size_t>(n) * t + t;
+    std::vector<double> partials(partialSize * numShards, 0.0);
+    ThreadPool::Global().ParallelFor(0, numShards, 1, [&](int first, int last) {
+        for (int s = first; s < last; s++) {
+            double* shardR = partials.data() + partialSize * s;
+            const int rowBegin = static_cast<int>(static_cast<long long>(numRows) * s / numShards);
+            const int rowEnd = static_cast<int>(static_cast<long long>(numRows) * (s + 1) / numShards);
+            AbsorbRows(X, ldx, Y, ldy, rowBegin, rowEnd, n, t, shardR, n, shardR + n * n, t, shardR + n * n + n * t);
+        }
+    });
+
+    // Stack the shard factors under R in a fixed order
+    for (int s = 0; s < numShards; s++) {
+        const double* shardR = partials.data() + partialSize * s;
+        const double* shardD = shardR + n * n;
+        const double* shardSquares = shardD + n * t;
+        AbsorbRows(shardR, n, shardD, t, 0, n, n, t, R, mR.GetStride(), d, mRotatedTargets.GetStride(), squares);
+        for (int k = 0; k < t; k++) squares[k] += shardSquares[k];
+    }
+    mNumRows += numRows;
+}
+
+void RegressionAccumulator::AddRows(const Matrix& X, const Matrix& Y) {
+    if (X.GetNumCols() != mNumFeatures || Y.GetNumCols() != mNumTargets || X.GetNumRows() != Y.GetNumRows()) {
+        throw std::invalid_argument("Batch dimensions do not match the accumulator");
+    }
+    AddRows(X.GetNumRows(), X.GetData(), X.GetStride(), Y.GetData(), Y.GetStride());
+}
+
+void RegressionAccumulator::AddRows(const Matrix& X, const Vector& y) {
+    if (X.GetNumCols() != mNumFeatures || mNumTargets != 1 || X.GetNumRows() != y.GetSize()) {
+        throw std::invalid_argument("Batch dimensions do not match the accumulator");
+    }
+    AddRows(X.GetNumRows(), X.GetData(), X.GetStride(), y.GetData(), 1);
+}
+
+// QR of [R | d] stacked on other's [R | d]; the residuals add
+void RegressionAccumulator::Merge(const RegressionAccumulator& other) {
+    if (other.mNumFeatures != mNumFeatures || other.mNumTargets != mNumTargets) {
+        throw std::invalid_argument("Accumulators must have the same dimensions");
+    }
+    AbsorbRows(other.mR.GetData(), other.mR.GetStride(), other.mRotatedTargets.GetData(),
+               other.mRotatedTargets.GetStride(), 0, mNumFeatures, mNumFeatures, mNumTargets,
+               mR.GetData(), mR.GetStride(), mRotatedTargets.GetData(), mRotatedTargets.GetStride(),
+               mResidualSquares.GetData());
+    mResidualSquares += other.mResidualSquares;
+    mNumRows += other.mNumRows;
+}
+
+/**
+ * Downdates [R | d] by each row of other's [R | d]. The residual of the
+ * remaining rows is this residual minus other's and minus what the
+ * downdates removed; a difference more negative than rounding on the scale
+ * of y^T y (n * eps * y^T y) means other's rows were not part of this data.
+ */
+void RegressionAccumulator::Subtract(const RegressionAccumulator& other) {
+    if (other.mNumFeatures != mNumFeatures || other.mNumTargets != mNumTargets) {
+        throw std::invalid_argument("Accumulators must have the same dimensions");
+    }
+    if (other.mNumRows > mNumRows) {
+        throw std::invalid_argument("Cannot remove more rows than were added");
+    }
+    const int n = mNumFeatures;
+    const int t = mNumTargets;
+    Matrix R = mR;
+    Matrix d = mRotatedTargets;
+    std::vector<double> work(3 * n);
+    std::vector<double> removed(t, 0.0);
+    for (int i = 0; i < n; i++) {
+        DowndateRow(R.GetData(), R.GetStride(), d.GetData(), d.GetStride(),
+                    other.mR.GetData() + static_cast<std::size_t>(i) * other.mR.GetStride(),
+                    other.mRotatedTargets.GetData() + static_cast<std::size_t>(i) * other.mRotatedTargets.GetStride(),
+                    n, t, work.data(), removed.data());
+    }
+
+    const Vector targetSquares = GetTargetSquares();
+    Vector residual(t);
+    for (int k = 0; k < t; k++) {
+        residual[k] = mResidualSquares[k] - other.mResidualSquares[k] - removed[k];
+        if (residual[k] < -n * std::numeric_limits<double>::epsilon() * targetSquares[k]) {
+            throw std::runtime_error("Removed rows were not part of the accumulated data");
+        }
+        residual[k] = std::max(0.0, residual[k]);
+    }
+    mR = std::move(R);
+    mRotatedTargets = std::move(d);
+    mResidualSquares = std::move(residual);
+    mNumRows -= other.mNumRows;
+}
+
+int RegressionAccumulator::GetNumFeatures() const { return mNumFeatures; }
+int RegressionAccumulator::GetNumTargets() const { return mNumTargets; }
+long long RegressionAccumulator::GetNumRows() const { return mNumRows; }
+const Matrix& RegressionAccumulator::GetR() const { return mR; }
+const Matrix& RegressionAccumulator::GetRotatedTargets() const { return mRotatedTargets; }
+const Vector& RegressionAccumulator::GetResidualSquares() const { return mResidualSquares; }
+
+Matrix RegressionAccumulator::GetGram() const {
+    return mR.Transpose() * mR;
+}
+
+Matrix RegressionAccumulator::GetCrossProducts() const {
+    return mR.Transpose() * mRotatedTargets;
+}
+
+Vector RegressionAccumulator::GetTargetSquares() const {
+    Vector squares = mResidualSquares;
+    for (int k = 1; k <= mNumTargets; k++) {
+        for (int i = 1; i <= mNumFeatures; i++) squares(k) += mRotatedTargets(i, k) * mRotatedTargets(i, k);
+    }
+    return squares;
+}
+
+/**
+ * A column is dependent if R_ii is negligible next to the column's norm
+ * (max(m, n) * eps * ||R e_i||), so the test ignores how features are scaled
+ */
+bool RegressionAccumulator::IsFullRank() const {
+    const double factor = std::max(static_cast<double>(mNumRows), static_cast<double>(mNumFeatures)) *
+                          std::numeric_limits<double>::epsilon();
+    for (int i = 1; i <= mNumFeatures; i++) {
+        double columnSquares = 0.0;
+        for (int r = 1; r <= i; r++) columnSquares += mR(r, i) * mR(r, i);
+        if (!(mR(i, i) > factor * std::sqrt(columnSquares))) return false;
+    }
+    return true;
+}
+
+/**
+ * Back substitution R b = d for every target
+ * @return n x t coefficient matrix
+ * @throws std::runtime_error if a feature is identically zero or a combination of the others
+ */
+Matrix RegressionAccumulator::Solve() const {
+    if (!IsFullRank()) {
+        throw std::runtime_error("Features are linearly dependent");
+    }
+    const int n = mNumFeatures;
+    Matrix coefficients(n, mNumTargets);
+    for (int k = 1; k <= mNumTargets; k++) {
+        for (int i = n; i >= 1; i--) {
+            double sum = mRotatedTargets(i, k);
+            for (int j = i + 1; j <= n; j++) sum -= mR(i, j) * coefficients(j, k);
+            coefficients(i, k) = sum / mR(i, i);
+        }
+    }
+    return coefficients;
+}
+
+/**
+ * Residual sums of squares without revisiting the rows. y - X b splits into
+ * Q (d - R b) and the part of y outside the column space of X, so both
+ * terms are sums of squares and nothing cancels.
+ * @param coefficients n x t, e.g. from Solve()
+ * @return One value per target
+ * @throws std::invalid_argument if the coefficients have the wrong shape
+ */
+Vector RegressionAccumulator::ResidualSumOfSquares(const Matrix& coefficients) const {
+    if (coefficients.GetNumRows() != mNumFeatures || coefficients.GetNumCols() != mNumTargets) {
+        throw std::invalid_argument("Coefficient dimensions do not match the accumulator");
+    }
+    const int n = mNumFeatures;
+    Vector rss = mResidualSquares;
+    for (int k = 1; k <= mNumTargets; k++) {
+        for (int i = 1; i <= n; i++) {
+            double difference = mRotatedTargets(i, k);
+            for (int j = i; j <= n; j++) difference -= mR(i, j) * coefficients(j, k);
+            rss(k) += difference * difference;
+        }
+    }
+    return rss;
+}
+
+Vector RegressionAccumulator::RootMeanSquaredError(const Matrix& coefficients) const {
+    if (mNumRows == 0) {
+        throw std::runtime_error("No rows have been accumulated");
+    }
+    Vector rmse = ResidualSumOfSquares(coefficients);
+    for (int k = 1; k <= mNumTargets; k++) rmse(k) = std::sqrt(rmse(k) / static_cast<double>(mNumRows));
+    return rmse;
+}
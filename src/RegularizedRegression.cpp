@@ -0,0 +1,234 @@
+#include "RegularizedRegression.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+double SoftThreshold(double z, double threshold) {
+    if (z > threshold) return z - threshold;
+    if (z < -threshold) return z + threshold;
+    return 0.0;
+}
+
+RegularizationPath MakePath(const Vector& lambdas, int numFeatures) {
+    RegularizationPath path;
+    path.lambdas = lambdas;
+    path.coefficients = Matrix(numFeatures, lambdas.GetSize());
+    path.trainRMSE = Vector(lambdas.GetSize());
+    path.activeCounts.assign(lambdas.GetSize(), 0);
+    path.sweeps.assign(lambdas.GetSize(), 0);
+    path.converged = true;
+    return path;
+}
+}
+
+/**
+ * Scales the accumulated sums to unit root-mean-square features
+ * @param data Accumulated rows
+ * @param target 1-based target column
+ * @throws std::invalid_argument if no rows were accumulated or target is out of range
+ */
+RegularizedRegression::RegularizedRegression(const RegressionAccumulator& data, int target)
+    : mNumFeatures(data.GetNumFeatures()), mNumRows(data.GetNumRows()), mTargetMeanSquare(0.0) {
+    if (mNumRows == 0) {
+        throw std::invalid_argument("No rows have been accumulated");
+    }
+    if (target < 1 || target > data.GetNumTargets()) {
+        throw std::invalid_argument("Target index out of range");
+    }
+    const int n = mNumFeatures;
+    const double m = static_cast<double>(mNumRows);
+    const Matrix gram = data.GetGram();
+    const Matrix cross = data.GetCrossProducts();
+    mScale = Vector(n);
+    for (int i = 1; i <= n; i++) {
+        mScale(i) = gram(i, i) > 0.0 ? std::sqrt(m / gram(i, i)) : 0.0;
+    }
+    mGram = Matrix(n, n);
+    mCorrelations = Vector(n);
+    for (int i = 1; i <= n; i++) {
+        for (int j = 1; j <= n; j++) mGram(i, j) = mScale(i) * gram(i, j) * mScale(j) / m;
+        mCorrelations(i) = mScale(i) * cross(i, target) / m;
+    }
+    mTargetMeanSquare = data.GetTargetSquares()(target) / m;
+}
+
+int RegularizedRegression::GetNumFeatures() const { return mNumFeatures; }
+
+// Eigendecomposition of the scaled Gram matrix, computed on the first call;
+// concurrent ridge paths wait for one decomposition
+const SymmetricEigenSolver& RegularizedRegression::GetEigenSolver() const {
+    std::call_once(mEigenOnce, [this]() { mpEigen.reset(new SymmetricEigenSolver(mGram)); });
+    return *mpEigen;
+}
+
+double RegularizedRegression::MaxLambda(double alpha) const {
+    if (!(alpha > 0.0 && alpha <= 1.0)) {
+        throw std::invalid_argument("Alpha must be in (0, 1]");
+    }
+    double maxCorrelation = 0.0;
+    for (int i = 1; i <= mNumFeatures; i++) maxCorrelation = std::max(maxCorrelation, std::fabs(mCorrelations(i)));
+    return maxCorrelation / alpha;
+}
+
+Vector RegularizedRegression::LambdaGrid(double maxLambda, double ratio, int count) {
+    if (!(maxLambda > 0.0) || !(ratio > 0.0 && ratio < 1.0) || count < 2) {
+        throw std::invalid_argument("Lambda grid needs maxLambda > 0, 0 < ratio < 1 and count >= 2");
+    }
+    Vector lambdas(count);
+    for (int l = 0; l < count; l++) {
+        lambdas[l] = maxLambda * std::pow(ratio, static_cast<double>(l) / (count - 1));
+    }
+    return lambdas;
+}
+
+// sqrt(y^T y / m - 2 b^T c + b^T S b) in scaled units
+double RegularizedRegression::TrainRMSE(const double* b) const {
+    double meanSquare = mTargetMeanSquare;
+    for (int i = 0; i < mNumFeatures; i++) {
+        if (b[i] == 0.0) continue;
+        double Sb = 0.0;
+        for (int j = 0; j < mNumFeatures; j++) Sb += mGram(i + 1, j + 1) * b[j];
+        meanSquare += b[i] * (Sb - 2.0 * mCorrelations[i]);
+    }
+    return std::sqrt(std::max(0.0, meanSquare));
+}
+
+void RegularizedRegression::StorePathPoint(RegularizationPath& path, int point,
+                                           const std::vector<double>& b) const {
+    int active = 0;
+    for (int i = 0; i < mNumFeatures; i++) {
+        path.coefficients(i + 1, point + 1) = mScale[i] * b[i];
+        if (b[i] != 0.0) active++;
+    }
+    path.activeCounts[point] = active;
+    path.trainRMSE[point] = TrainRMSE(b.data());
+}
+
+/**
+ * b(lambda) = V diag(1 / (e + lambda)) V^T c from one eigendecomposition
+ * S = V diag(e) V^T, so each lambda costs O(n^2)
+ * @param lambdas Penalties in any order
+ * @return Path with one column per lambda
+ * @throws std::invalid_argument if a lambda is negative
+ * @throws std::runtime_error if e + lambda is negligible for some eigenvalue
+ */
+RegularizationPath RegularizedRegression::RidgePath(const Vector& lambdas) const {
+    const int n = mNumFeatures;
+    const SymmetricEigenSolver& eigen = GetEigenSolver();
+    const Vector& eigenvalues = eigen.GetEigenvalues();
+    const Matrix& V = eigen.GetEigenvectors();
+    const double tolerance = n * std::numeric_limits<double>::epsilon() *
+                             std::max(std::fabs(eigenvalues(1)), std::fabs(eigenvalues(n)));
+
+    Vector projection(n);   // V^T c
+    for (int k = 1; k <= n; k++) {
+        for (int i = 1; i <= n; i++) projection(k) += V(i, k) * mCorrelations(i);
+    }
+
+    RegularizationPath path = MakePath(lambdas, n);
+    std::vector<double> b(n);
+    for (int l = 0; l < lambdas.GetSize(); l++) {
+        if (!(lambdas[l] >= 0.0)) {
+            throw std::invalid_argument("Ridge penalties must be non-negative");
+        }
+        std::fill(b.begin(), b.end(), 0.0);
+        for (int k = 1; k <= n; k++) {
+            const double shifted = eigenvalues(k) + lambdas[l];
+            if (projection(k) == 0.0) continue;   // Also covers all-zero features
+            if (!(shifted > tolerance)) {
+                throw std::runtime_error("Ridge system is singular for this penalty");
+            }
+            const double weight = projection(k) / shifted;
+            for (int i = 1; i <= n; i++) b[i - 1] += V(i, k) * weight;
+        }
+        StorePathPoint(path, l, b);
+    }
+    return path;
+}
+
+/**
+ * Cyclic coordinate descent with covariance updates: the residual
+ * correlations r = c - S b are kept current, so a coordinate update costs
+ * O(1) and each change of a coefficient O(n). Each lambda starts from the
+ * previous solution. With screening, a feature joins the working set when
+ * |r_j| >= alpha (2 lambda - lambda_prev) (sequential strong rule) or when
+ * it violates the KKT condition |r_j| <= alpha lambda after convergence.
+ * @param lambdas Positive, non-increasing penalties
+ * @param alpha Lasso share of the penalty; 0 is ridge, 1 is the lasso
+ * @param options Sweep limit, tolerance and screening switch
+ * @return Path with one column per lambda; converged is false if a lambda hit the sweep limit
+ * @throws std::invalid_argument unless 0 <= alpha <= 1 and the lambdas are positive and non-increasing
+ */
+RegularizationPath RegularizedRegression::ElasticNetPath(const Vector& lambdas, double alpha,
+                                                         const CoordinateDescentOptions& options) const {
+    if (!(alpha >= 0.0 && alpha <= 1.0)) {
+        throw std::invalid_argument("Alpha must be in [0, 1]");
+    }
+    for (int l = 0; l < lambdas.GetSize(); l++) {
+        if (!(lambdas[l] > 0.0) || (l > 0 && lambdas[l] > lambdas[l - 1])) {
+            throw std::invalid_argument("Lambdas must be positive and non-increasing");
+        }
+    }
+    const int n = mNumFeatures;
+    const bool screening = options.screening && alpha > 0.0;
+    std::vector<double> b(n, 0.0);
+    std::vector<double> r(mCorrelations.GetData(), mCorrelations.GetData() + n);
+    std::vector<char> inWorkingSet(n, screening ? 0 : 1);
+    std::vector<int> workingSet;
+    double previousLambda = screening ? MaxLambda(alpha) : 0.0;
+
+    RegularizationPath path = MakePath(lambdas, n);
+    for (int l = 0; l < lambdas.GetSize(); l++) {
+        const double lambda = lambdas[l];
+        const double l1 = lambda * alpha;
+        const double l2 = lambda * (1.0 - alpha);
+        if (screening) {
+            const double strongThreshold = alpha * (2.0 * lambda - previousLambda);
+            for (int j = 0; j < n; j++) {
+                if (std::fabs(r[j]) >= strongThreshold) inWorkingSet[j] = 1;
+            }
+        }
+
+        bool converged = false;
+        for (;;) {
+            workingSet.clear();
+            for (int j = 0; j < n; j++) {
+                if (inWorkingSet[j]) workingSet.push_back(j);
+            }
+            converged = false;
+            while (!converged && path.sweeps[l] < options.maxSweeps) {
+                path.sweeps[l]++;
+                double maxChange = 0.0;
+                for (std::size_t w = 0; w < workingSet.size(); w++) {
+                    const int j = workingSet[w];
+                    const double* Sj = mGram.GetData() + static_cast<std::size_t>(j) * mGram.GetStride();
+                    if (Sj[j] == 0.0) continue;
+                    const double updated = SoftThreshold(r[j] + Sj[j] * b[j], l1) / (Sj[j] + l2);
+                    const double delta = updated - b[j];
+                    if (delta == 0.0) continue;
+                    b[j] = updated;
+                    for (int k = 0; k < n; k++) r[k] -= delta * Sj[k];
+                    maxChange = std::max(maxChange, std::fabs(delta) * std::sqrt(Sj[j]));
+                }
+                converged = maxChange < options.tolerance;
+            }
+            if (!screening || !converged) break;
+
+            // Screened-out features must satisfy the KKT condition at b_j = 0
+            bool violation = false;
+            for (int j = 0; j < n; j++) {
+                if (!inWorkingSet[j] && std::fabs(r[j]) > l1) {
+                    inWorkingSet[j] = 1;
+                    violation = true;
+                }
+            }
+            if (!violation) break;
+        }
+        path.converged = path.converged && converged;
+        StorePathPoint(path, l, b);
+        previousLambda = lambda;
+    }
+    return path;
+}
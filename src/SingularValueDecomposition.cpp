@@ -0,0 +1,281 @@
+#include "SingularValueDecomposition.h"
+#include "Gemm.h"
+#include "QRFactorization.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace {
+// Tall matrices (m >= ratio * n) are reduced by QR before the Jacobi sweeps
+const int kQRFirstRatio = 2;
+
+const int kMaxJacobiSweeps = 60;
+
+// Row elements per parallel task when rotating row pairs
+const int kParallelElements = 1 << 14;
+
+/**
+ * One-sided Jacobi on the rows of Wt (the columns of W = Wt^T), accumulating
+ * the same rotations into the rows of Vt. Pairs are visited in round-robin
+ * tournament order so each round rotates disjoint rows in parallel.
+ */
+void OneSidedJacobi(Matrix& Wt, Matrix& Vt) {
+    const int n = Wt.GetNumRows();
+    const int m = Wt.GetNumCols();
+    if (n < 2) return;
+    double* w = Wt.GetData();
+    const int ldw = Wt.GetStride();
+    double* v = Vt.GetData();
+    const int ldv = Vt.GetStride();
+    const double eps = std::numeric_limits<double>::epsilon();
+
+    const int players = n + (n % 2);           // Odd n gets a bye (-1)
+    std::vector<int> order(players);
+    std::iota(order.begin(), order.end(), 0);
+    if (players > n) order[players - 1] = -1;
+    const int numPairs = players / 2;
+    const int grain = std::max(1, kParallelElements / std::max(1, m + n));
+
+    for (int sweep = 0; sweep < kMaxJacobiSweeps; sweep++) {
+        std::atomic<bool> rotated(false);
+        for (int round = 0; round < players - 1; round++) {
+            ThreadPool::Global().ParallelFor(0, numPairs, grain, [&](int first, int last) {
+                bool any = false;
+                for (int k = first; k < last; k++) {
+                    int p = order[k];
+                    int q = order[players - 1 - k];
+                    if (p < 0 || q < 0) continue;
+                    if (p > q) std::swap(p, q);
+                    double* wp = w + static_cast<std::size_t>(p) * ldw;
+                    double* wq = w + static_cast<std::size_t>(q) * ldw;
+                    double alpha = 0.0, beta = 0.0, gamma = 0.0;
+                    for (int i = 0; i < m; i++) {
+                        alpha += wp[i] * wp[i];
+                        beta += wq[i] * wq[i];
+                        gamma += wp[i] * wq[i];
+                    }
+                    if (std::abs(gamma) <= eps * std::sqrt(alpha * beta)) continue;
+                    any = true;
+                    const double zeta = (beta - alpha) / (2.0 * gamma);
+                    const double t = (zeta >= 0.0 ? 1.0 : -1.0) / (std::abs(zeta) + std::sqrt(1.0 + zeta * zeta));
+                    const double c = 1.0 / std::sqrt(1.0 + t * t);
+                    const double s = c * t;
+                    for (int i = 0; i < m; i++) {
+                        const double a = wp[i], b = wq[i];
+                        wp[i] = c * a - s * b;
+                        wq[i] = s * a + c * b;
+                    }
+                    double* vp = v + static_cast<std::size_t>(p) * ldv;
+                    double* vq = v + static_cast<std::size_t>(q) * ldv;
+                    for (int i = 0; i < n; i++) {
+                        const double a = vp[i], b = vq[i];
+                        vp[i] = c * a - s * b;
+                        vq[i] = s * a + c * b;
+                    }
+                }
+                if (any) rotated = true;
+            });
+            // Keep order[0] fixed and rotate the others one place
+            std::rotate(order.begin() + 1, order.end() - 1, order.end());
+        }
+        if (!rotated) return;
+    }
+}
+}
+
+SingularValueDecomposition::SingularValueDecomposition() : mNumRows(0), mNumCols(0) {}
+
+/**
+ * Computes the full thin SVD
+ * @param A Non-empty matrix of any shape
+ * @throws std::invalid_argument if A is empty
+ */
+SingularValueDecomposition::SingularValueDecomposition(const Matrix& A)
+    : mNumRows(A.GetNumRows()), mNumCols(A.GetNumCols()) {
+    if (mNumRows == 0 || mNumCols == 0) {
+        throw std::invalid_argument("Cannot decompose an empty matrix");
+    }
+    Compute(A);
+}
+
+void SingularValueDecomposition::Compute(const Matrix& A) {
+    if (A.GetNumRows() >= A.GetNumCols()) {
+        ComputeTall(A);
+    } else {
+        // A^T = U' S V'^T gives A = V' S U'^T
+        ComputeTall(A.Transpose());
+        std::swap(mU, mV);
+    }
+}
+
+// Thin SVD of an m x n matrix with m >= n
+void SingularValueDecomposition::ComputeTall(const Matrix& A) {
+    const int m = A.GetNumRows();
+    const int n = A.GetNumCols();
+    const bool reduceFirst = m >= kQRFirstRatio * n;
+    std::unique_ptr<QRFactorization> qr(reduceFirst ? new QRFactorization(A) : nullptr);
+    Matrix Wt = reduceFirst ? qr->GetR().Transpose() : A.Transpose();
+    const int wCols = Wt.GetNumCols();
+    Matrix Vt(n, n);
+    for (int i = 0; i < n; i++) Vt.GetData()[static_cast<std::size_t>(i) * Vt.GetStride() + i] = 1.0;
+    OneSidedJacobi(Wt, Vt);
+
+    // Column norms of W are the singular values; sort them in descending order
+    std::vector<double> norms(n);
+    for (int j = 0; j < n; j++) {
+        const double* row = Wt.GetData() + static_cast<std::size_t>(j) * Wt.GetStride();
+        double sum = 0.0;
+        for (int i = 0; i < wCols; i++) sum += row[i] * row[i];
+        norms[j] = std::sqrt(sum);
+    }
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return norms[a] > norms[b]; });
+
+    // Rows of U beyond the R factor start at zero; Q fills them in below
+    Matrix U(reduceFirst ? m : wCols, n);
+    mSingularValues = Vector(n);
+    mV = Matrix(n, n);
+    for (int k = 0; k < n; k++) {
+        const int j = order[k];
+        const double s = norms[j];
+        mSingularValues[k] = s;
+        const double* rowW = Wt.GetData() + static_cast<std::size_t>(j) * Wt.GetStride();
+        const double inv = s > 0.0 ? 1.0 / s : 0.0;
+        for (int i = 0; i < wCols; i++) U.GetData()[static_cast<std::size_t>(i) * U.GetStride() + k] = rowW[i] * inv;
+        const double* rowV = Vt.GetData() + static_cast<std::size_t>(j) * Vt.GetStride();
+        for (int i = 0; i < n; i++) mV.GetData()[static_cast<std::size_t>(i) * mV.GetStride() + k] = rowV[i];
+    }
+    if (reduceFirst) {
+        qr->ApplyQ(U);   // U = Q [U_R; 0]
+    }
+    mU = U;
+}
+
+SingularValueDecomposition SingularValueDecomposition::Randomized(const Matrix& A, int rank, int oversampling,
+                                                                  int powerIterations, unsigned int seed) {
+    const int m = A.GetNumRows();
+    const int n = A.GetNumCols();
+    if (rank < 1 || rank > std::min(m, n)) {
+        throw std::invalid_argument("Requested rank must be between 1 and min(rows, cols)");
+    }
+    const int l = std::min(std::min(m, n), rank + std::max(0, oversampling));
+    const double* a = A.GetData();
+    const int lda = A.GetStride();
+
+    // Y = A Omega for a Gaussian n x l test matrix
+    std::mt19937 generator(seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    Matrix Omega(n, l);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < l; j++) Omega.GetData()[static_cast<std::size_t>(i) * Omega.GetStride() + j] = normal(generator);
+    }
+    Matrix Y(m, l);
+    Gemm(false, false, m, l, n, 1.0, a, lda, Omega.GetData(), Omega.GetStride(), 0.0, Y.GetData(), Y.GetStride());
+
+    // Power iterations, re-orthonormalized each pass to keep small directions
+    Matrix Z(n, l);
+    for (int it = 0; it < powerIterations; it++) {
+        const Matrix Q = QRFactorization(Y).GetQ();
+        Gemm(true, false, n, l, m, 1.0, a, lda, Q.GetData(), Q.GetStride(), 0.0, Z.GetData(), Z.GetStride());
+        const Matrix QZ = QRFactorization(Z).GetQ();
+        Gemm(false, false, m, l, n, 1.0, a, lda, QZ.GetData(), QZ.GetStride(), 0.0, Y.GetData(), Y.GetStride());
+    }
+    const Matrix Q = QRFactorization(Y).GetQ();
+
+    // B^T = A^T Q is n x l; its SVD Ub S Vb^T gives B = Vb S Ub^T
+    Gemm(true, false, n, l, m, 1.0, a, lda, Q.GetData(), Q.GetStride(), 0.0, Z.GetData(), Z.GetStride());
+    const SingularValueDecomposition small(Z);
+
+    SingularValueDecomposition result;
+    result.mNumRows = m;
+    result.mNumCols = n;
+    result.mSingularValues = Vector(rank);
+    for (int k = 0; k < rank; k++) result.mSingularValues[k] = small.mSingularValues[k];
+    result.mU = Matrix(m, rank);
+    Gemm(false, false, m, rank, l, 1.0, Q.GetData(), Q.GetStride(), small.mV.GetData(), small.mV.GetStride(),
+         0.0, result.mU.GetData(), result.mU.GetStride());
+    result.mV = Matrix(n, rank);
+    for (int i = 0; i < n; i++) {
+        const double* src = small.mU.GetData() + static_cast<std::size_t>(i) * small.mU.GetStride();
+        std::copy(src, src + rank, result.mV.GetData() + static_cast<std::size_t>(i) * result.mV.GetStride());
+    }
+    return result;
+}
+
+int SingularValueDecomposition::GetNumRows() const { return mNumRows; }
+int SingularValueDecomposition::GetNumCols() const { return mNumCols; }
+const Matrix& SingularValueDecomposition::GetU() const { return mU; }
+const Vector& SingularValueDecomposition::GetSingularValues() const { return mSingularValues; }
+const Matrix& SingularValueDecomposition::GetV() const { return mV; }
+
+double SingularValueDecomposition::ResolveTolerance(double tolerance) const {
+    if (tolerance >= 0.0) return tolerance;
+    const double largest = mSingularValues.GetSize() > 0 ? mSingularValues[0] : 0.0;
+    return std::max(mNumRows, mNumCols) * std::numeric_limits<double>::epsilon() * largest;
+}
+
+int SingularValueDecomposition::GetRank(double tolerance) const {
+    const double cutoff = ResolveTolerance(tolerance);
+    int rank = 0;
+    while (rank < mSingularValues.GetSize() && mSingularValues[rank] > cutoff) rank++;
+    return rank;
+}
+
+double SingularValueDecomposition::ConditionNumber() const {
+    const int k = mSingularValues.GetSize();
+    if (k == 0) return 0.0;
+    if (mSingularValues[k - 1] == 0.0) return std::numeric_limits<double>::infinity();
+    return mSingularValues[0] / mSingularValues[k - 1];
+}
+
+/**
+ * Builds the pseudo-inverse from the singular triplets above the cutoff
+ * @param tolerance Singular values at or below this are treated as zero
+ * @return n x m pseudo-inverse
+ */
+Matrix SingularValueDecomposition::PseudoInverse(double tolerance) const {
+    const int rank = GetRank(tolerance);
+    const int n = mV.GetNumRows();
+    const int m = mU.GetNumRows();
+    Matrix VScaled(n, std::max(rank, 1));
+    for (int i = 0; i < n; i++) {
+        const double* rowV = mV.GetData() + static_cast<std::size_t>(i) * mV.GetStride();
+        double* row = VScaled.GetData() + static_cast<std::size_t>(i) * VScaled.GetStride();
+        for (int k = 0; k < rank; k++) row[k] = rowV[k] / mSingularValues[k];
+    }
+    Matrix result(n, m);
+    if (rank > 0) {
+        Gemm(false, true, n, m, rank, 1.0, VScaled.GetData(), VScaled.GetStride(),
+             mU.GetData(), mU.GetStride(), 0.0, result.GetData(), result.GetStride());
+    }
+    return result;
+}
+
+/**
+ * Solves min ||Ax - b|| with the smallest ||x||, as V diag(1/s) U^T b
+ * @param b Right-hand side with m entries
+ * @param tolerance Singular values at or below this are treated as zero
+ * @return Minimum-norm least-squares solution x
+ * @throws std::invalid_argument if b has the wrong size
+ */
+Vector SingularValueDecomposition::Solve(const Vector& b, double tolerance) const {
+    if (b.GetSize() != mU.GetNumRows()) {
+        throw std::invalid_argument("Right-hand side size does not match the decomposed matrix");
+    }
+    const int rank = GetRank(tolerance);
+    Vector coefficients(mSingularValues.GetSize());
+    mU.MultiplyTranspose(b, coefficients);
+    for (int k = 0; k < coefficients.GetSize(); k++) {
+        coefficients[k] = k < rank ? coefficients[k] / mSingularValues[k] : 0.0;
+    }
+    Vector x(mV.GetNumRows());
+    mV.Multiply(coefficients, x);
+    return x;
+}
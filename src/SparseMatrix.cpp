@@ -0,0 +1,308 @@
+#include "SparseMatrix.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+// Nonzeros per parallel task; smaller products run on the calling thread
+const int kParallelNonZeros = 1 << 15;
+
+// MultiplyTranspose reduces at most this many row bands; the cut depends only
+// on the shape and nonzero count, so the rounding is the same for any number
+// of threads. Every band past the first needs a partial vector of numCols
+// entries, so there are also at most nonzeros / numCols bands: the partials
+// never outgrow the matrix and a call stays O(nonzeros) in time and memory.
+const int kMaxBands = 64;
+
+int RowGrain(int numRows, int numNonZeros) {
+    const int perRow = std::max(1, numNonZeros / std::max(1, numRows));
+    return std::max(1, kParallelNonZeros / perRow);
+}
+}
+
+SparseMatrixBuilder::SparseMatrixBuilder(int numRows, int numCols) : mNumRows(numRows), mNumCols(numCols) {
+    if (numRows < 0 || numCols < 0) {
+        throw std::invalid_argument("Matrix dimensions must be non-negative");
+    }
+}
+
+void SparseMatrixBuilder::Reserve(int numEntries) {
+    mRows.reserve(numEntries);
+    mCols.reserve(numEntries);
+    mValues.reserve(numEntries);
+}
+
+void SparseMatrixBuilder::Add(int i, int j, double value) {
+    if (i < 1 || i > mNumRows || j < 1 || j > mNumCols) {
+        throw std::out_of_range("Matrix index out of range");
+    }
+    mRows.push_back(i - 1);
+    mCols.push_back(j - 1);
+    mValues.push_back(value);
+}
+
+int SparseMatrixBuilder::GetNumRows() const { return mNumRows; }
+int SparseMatrixBuilder::GetNumCols() const { return mNumCols; }
+int SparseMatrixBuilder::GetNumEntries() const { return static_cast<int>(mValues.size()); }
+
+SparseMatrix SparseMatrixBuilder::Build() const {
+    return SparseMatrix(*this);
+}
+
+SparseMatrix::SparseMatrix() : mNumRows(0), mNumCols(0), mRowPointers(1, 0) {}
+
+SparseMatrix::SparseMatrix(int numRows, int numCols)
+    : mNumRows(numRows), mNumCols(numCols), mRowPointers(numRows >= 0 ? numRows + 1 : 1, 0) {
+    if (numRows < 0 || numCols < 0) {
+        throw std::invalid_argument("Matrix dimensions must be non-negative");
+    }
+}
+
+// Counting sort of the entries by row, then a sort and merge of duplicates
+// within each row
+SparseMatrix::SparseMatrix(const SparseMatrixBuilder& builder)
+    : mNumRows(builder.mNumRows), mNumCols(builder.mNumCols), mRowPointers(builder.mNumRows + 1, 0) {
+    const std::size_t numEntries = builder.mValues.size();
+    for (std::size_t k = 0; k < numEntries; k++) mRowPointers[builder.mRows[k] + 1]++;
+    for (int i = 0; i < mNumRows; i++) mRowPointers[i + 1] += mRowPointers[i];
+
+    std::vector<std::pair<int, double> > entries(numEntries);
+    std::vector<int> next(mRowPointers.begin(), mRowPointers.end() - 1);
+    for (std::size_t k = 0; k < numEntries; k++) {
+        entries[next[builder.mRows[k]]++] = std::make_pair(builder.mCols[k], builder.mValues[k]);
+    }
+
+    mColumnIndices.reserve(numEntries);
+    mValues.reserve(numEntries);
+    int rowStart = 0;
+    for (int i = 0; i < mNumRows; i++) {
+        const int rowEnd = mRowPointers[i + 1];
+        std::sort(entries.begin() + rowStart, entries.begin() + rowEnd,
+                  [](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+                      return a.first < b.first;
+                  });
+        mRowPointers[i] = static_cast<int>(mValues.size());
+        for (int k = rowStart; k < rowEnd; k++) {
+            if (k > rowStart && entries[k].first == entries[k - 1].first) {
+                mValues.back() += entries[k].second;
+            } else {
+                mColumnIndices.push_back(entries[k].first);
+                mValues.push_back(entries[k].second);
+            }
+        }
+        rowStart = rowEnd;
+    }
+    mRowPointers[mNumRows] = static_cast<int>(mValues.size());
+}
+
+SparseMatrix SparseMatrix::FromDense(const Matrix& A, double dropTolerance) {
+    SparseMatrix S(A.GetNumRows(), A.GetNumCols());
+    const double* a = A.GetData();
+    const int lda = A.GetStride();
+    for (int i = 0; i < S.mNumRows; i++) {
+        const double* row = a + static_cast<std::size_t>(i) * lda;
+        for (int j = 0; j < S.mNumCols; j++) {
+            if (std::abs(row[j]) > dropTolerance) {
+                S.mColumnIndices.push_back(j);
+                S.mValues.push_back(row[j]);
+            }
+        }
+        S.mRowPointers[i + 1] = static_cast<int>(S.mValues.size());
+    }
+    return S;
+}
+
+Matrix SparseMatrix::ToDense() const {
+    Matrix A(mNumRows, mNumCols);
+    double* a = A.GetData();
+    const int lda = A.GetStride();
+    for (int i = 0; i < mNumRows; i++) {
+        double* row = a + static_cast<std::size_t>(i) * lda;
+        for (int k = mRowPointers[i]; k < mRowPointers[i + 1]; k++) {
+            row[mColumnIndices[k]] = mValues[k];
+        }
+    }
+    return A;
+}
+
+int SparseMatrix::GetNumRows() const { return mNumRows; }
+int SparseMatrix::GetNumCols() const { return mNumCols; }
+int SparseMatrix::GetNumNonZeros() const { return static_cast<int>(mValues.size()); }
+
+double SparseMatrix::operator()(int i, int j) const {
+    if (i < 1 || i > mNumRows || j < 1 || j > mNumCols) {
+        throw std::out_of_range("Matrix index out of range");
+    }
+    const int* first = mColumnIndices.data() + mRowPointers[i - 1];
+    const int* last = mColumnIndices.data() + mRowPointers[i];
+    const int* it = std::lower_bound(first, last, j - 1);
+    if (it == last || *it != j - 1) return 0.0;
+    return mValues[it - mColumnIndices.data()];
+}
+
+const std::vector<int>& SparseMatrix::GetRowPointers() const { return mRowPointers; }
+const std::vector<int>& SparseMatrix::GetColumnIndices() const { return mColumnIndices; }
+const std::vector<double>& SparseMatrix::GetValues() const { return mValues; }
+
+void SparseMatrix::Multiply(const Vector& vec, Vector& result) const {
+    if (mNumCols != vec.GetSize())
+        throw std::invalid_argument("Matrix and vector dimensions must be compatible");
+    if (result.GetSize() != mNumRows)
+        throw std::invalid_argument("Result vector has the wrong size");
+    if (&vec == &result)
+        throw std::invalid_argument("Result vector must not alias the input");
+    const double* x = vec.GetData();
+    double* y = result.GetData();
+    const int* rowPtr = mRowPointers.data();
+    const int* col = mColumnIndices.data();
+    const double* val = mValues.data();
+
+    // Rows are independent, so each task streams its own slice of the arrays
+    ThreadPool::Global().ParallelFor(0, mNumRows, RowGrain(mNumRows, GetNumNonZeros()), [&](int first, int last) {
+        for (int i = first; i < last; i++) {
+            double sum = 0.0;
+            for (int k = rowPtr[i]; k < rowPtr[i + 1]; k++) sum += val[k] * x[col[k]];
+            y[i] = sum;
+        }
+    });
+}
+
+void SparseMatrix::MultiplyTranspose(const Vector& vec, Vector& result) const {
+    if (mNumRows != vec.GetSize())
+        throw std::invalid_argument("Matrix and vector dimensions must be compatible");
+    if (result.GetSize() != mNumCols)
+        throw std::invalid_argument("Result vector has the wrong size");
+    if (&vec == &result)
+        throw std::invalid_argument("Result vector must not alias the input");
+    const double* x = vec.GetData();
+    double* y = result.GetData();
+    const int* rowPtr = mRowPointers.data();
+    const int* col = mColumnIndices.data();
+    const double* val = mValues.data();
+
+    // Scatter of row i into y; bands of rows scatter into their own partial
+    // vector (the first band into y) and the partials are added in band
+    // order, column by column (deterministic)
+    const int nnz = GetNumNonZeros();
+    const int numBands = std::max(1, std::min(std::min(kMaxBands, nnz / kParallelNonZeros),
+                                              nnz / std::max(1, mNumCols)));
+    for (int j = 0; j < mNumCols; j++) y[j] = 0.0;
+    if (numBands == 1) {
+        for (int i = 0; i < mNumRows; i++) {
+            const double xi = x[i];
+            for (int k = rowPtr[i]; k < rowPtr[i + 1]; k++) y[col[k]] += val[k] * xi;
+        }
+        return;
+    }
+
+    std::vector<double> partial(static_cast<std::size_t>(numBands - 1) * mNumCols, 0.0);
+    ThreadPool& pool = ThreadPool::Global();
+    pool.ParallelFor(0, numBands, 1, [&](int first, int last) {
+        for (int band = first; band < last; band++) {
+            double* acc = band == 0 ? y : partial.data() + static_cast<std::size_t>(band - 1) * mNumCols;
+            const int rowBegin = static_cast<int>(static_cast<long long>(mNumRows) * band / numBands);
+            const int rowEnd = static_cast<int>(static_cast<long long>(mNumRows) * (band + 1) / numBands);
+            for (int i = rowBegin; i < rowEnd; i++) {
+                const double xi = x[i];
+                for (int k = rowPtr[i]; k < rowPtr[i + 1]; k++) acc[col[k]] += val[k] * xi;
+            }
+        }
+    });
+    pool.ParallelFor(0, mNumCols, std::max(1, kParallelNonZeros / numBands), [&](int first, int last) {
+        for (int band = 1; band < numBands; band++) {
+            const double* acc = partial.data() + static_cast<std::size_t>(band - 1) * mNumCols;
+            for (int j = first; j < last; j++) y[j] += acc[j];
+        }
+    });
+}
+
+Vector SparseMatrix::operator*(const Vector& vec) const {
+    Vector result(mNumRows);
+    Multiply(vec, result);
+    return result;
+}
+
+void SparseMatrix::Apply(const Vector& x, Vector& y) const {
+    Multiply(x, y);
+}
+
+void SparseMatrix::ApplyTranspose(const Vector& x, Vector& y) const {
+    MultiplyTranspose(x, y);
+}
+
+// Counting sort by column; rows of the result come out already sorted
+SparseMatrix SparseMatrix::Transpose() const {
+    SparseMatrix T(mNumCols, mNumRows);
+    const int nnz = GetNumNonZeros();
+    for (int k = 0; k < nnz; k++) T.mRowPointers[mColumnIndices[k] + 1]++;
+    for (int j = 0; j < mNumCols; j++) T.mRowPointers[j + 1] += T.mRowPointers[j];
+
+    T.mColumnIndices.resize(nnz);
+    T.mValues.resize(nnz);
+    std::vector<int> next(T.mRowPointers.begin(), T.mRowPointers.end() - 1);
+    for (int i = 0; i < mNumRows; i++) {
+        for (int k = mRowPointers[i]; k < mRowPointers[i + 1]; k++) {
+            const int slot = next[mColumnIndices[k]]++;
+            T.mColumnIndices[slot] = i;
+            T.mValues[slot] = mValues[k];
+        }
+    }
+    return T;
+}
+
+Vector SparseMatrix::Diagonal() const {
+    const int n = std::min(mNumRows, mNumCols);
+    Vector d(n);
+    for (int i = 0; i < n; i++) {
+        d[i] = (*this)(i + 1, i + 1);
+    }
+    return d;
+}
+
+bool SparseMatrix::IsSquare() const {
+    return mNumRows == mNumCols;
+}
+
+// Merges each row with the matching row of the transpose; entries missing
+// from one pattern compare against zero
+bool SparseMatrix::IsSymmetric() const {
+    if (!IsSquare()) return false;
+
+    const double epsilon = 1e-10;  // Tolerance for floating-point comparison
+    const SparseMatrix T = Transpose();
+    for (int i = 0; i < mNumRows; i++) {
+        int a = mRowPointers[i];
+        int b = T.mRowPointers[i];
+        const int aEnd = mRowPointers[i + 1];
+        const int bEnd = T.mRowPointers[i + 1];
+        while (a < aEnd || b < bEnd) {
+            const int ca = a < aEnd ? mColumnIndices[a] : mNumCols;
+            const int cb = b < bEnd ? T.mColumnIndices[b] : mNumCols;
+            double diff;
+            if (ca == cb) {
+                diff = mValues[a++] - T.mValues[b++];
+            } else if (ca < cb) {
+                diff = mValues[a++];
+            } else {
+                diff = T.mValues[b++];
+            }
+            if (std::abs(diff) > epsilon) return false;
+        }
+    }
+    return true;
+}
+
+void SparseMatrix::Print() const {
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << mNumRows << " x " << mNumCols << ", " << GetNumNonZeros() << " nonzeros" << std::endl;
+    for (int i = 0; i < mNumRows; i++) {
+        for (int k = mRowPointers[i]; k < mRowPointers[i + 1]; k++) {
+            std::cout << "(" << i + 1 << ", " << mColumnIndices[k] + 1 << ") "
+                      << std::setw(8) << mValues[k] << std::endl;
+        }
+    }
+}
@@ -0,0 +1,382 @@
+#include "SymmetricEigenSolver.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// QL sweeps allowed per eigenvalue before giving up
+const int kMaxQLIterations = 30;
+
+// Default cap on the Krylov dimension of the Lanczos method
+const int kDefaultLanczosIterations = 200;
+
+// Ritz values are checked for convergence every this many Lanczos steps
+const int kLanczosCheckInterval = 5;
+
+/**
+ * Eigenvectors are kept transposed: row j of Z is the j-th vector. With
+ * row-major storage this makes every rotation and every Householder update
+ * below run along contiguous memory.
+ */
+struct Transposed {
+    double* z;
+    int ldz;
+    double& operator()(int row, int col) { return z[static_cast<std::size_t>(col) * ldz + row]; }
+};
+
+// Householder reduction of the symmetric matrix stored in V (transposed
+// layout) to tridiagonal form; d gets the diagonal, e the subdiagonal in
+// e[1..n-1], and V the accumulated orthogonal transform
+void Tridiagonalize(Transposed V, int n, std::vector<double>& d, std::vector<double>& e) {
+    for (int j = 0; j < n; j++) d[j] = V(n - 1, j);
+
+    for (int i = n - 1; i > 0; i--) {
+        double scale = 0.0;
+        double h = 0.0;
+        for (int k = 0; k < i; k++) scale += std::abs(d[k]);
+        if (scale == 0.0) {
+            e[i] = d[i - 1];
+            for (int j = 0; j < i; j++) {
+                d[j] = V(i - 1, j);
+                V(i, j) = 0.0;
+                V(j, i) = 0.0;
+            }
+        } else {
+            for (int k = 0; k < i; k++) {
+                d[k] /= scale;
+                h += d[k] * d[k];
+            }
+            double f = d[i - 1];
+            double g = std::sqrt(h);
+            if (f > 0) g = -g;
+            e[i] = scale * g;
+            h -= f * g;
+            d[i - 1] = f - g;
+            for (int j = 0; j < i; j++) e[j] = 0.0;
+
+            for (int j = 0; j < i; j++) {
+                f = d[j];
+                V(j, i) = f;
+                g = e[j] + V(j, j) * f;
+                for (int k = j + 1; k <= i - 1; k++) {
+                    g += V(k, j) * d[k];
+                    e[k] += V(k, j) * f;
+                }
+                e[j] = g;
+            }
+            f = 0.0;
+            for (int j = 0; j < i; j++) {
+                e[j] /= h;
+                f += e[j] * d[j];
+            }
+            const double hh = f / (h + h);
+            for (int j = 0; j < i; j++) e[j] -= hh * d[j];
+            for (int j = 0; j < i; j++) {
+                f = d[j];
+                g = e[j];
+                for (int k = j; k <= i - 1; k++) V(k, j) -= (f * e[k] + g * d[k]);
+                d[j] = V(i - 1, j);
+                V(i, j) = 0.0;
+            }
+        }
+        d[i] = h;
+    }
+
+    // Accumulate the transformations
+    for (int i = 0; i < n - 1; i++) {
+        V(n - 1, i) = V(i, i);
+        V(i, i) = 1.0;
+        const double h = d[i + 1];
+        if (h != 0.0) {
+            for (int k = 0; k <= i; k++) d[k] = V(k, i + 1) / h;
+            for (int j = 0; j <= i; j++) {
+                double g = 0.0;
+                for (int k = 0; k <= i; k++) g += V(k, i + 1) * V(k, j);
+                for (int k = 0; k <= i; k++) V(k, j) -= g * d[k];
+            }
+        }
+        for (int k = 0; k <= i; k++) V(k, i + 1) = 0.0;
+    }
+    for (int j = 0; j < n; j++) {
+        d[j] = V(n - 1, j);
+        V(n - 1, j) = 0.0;
+    }
+    V(n - 1, n - 1) = 1.0;
+    e[0] = 0.0;
+}
+
+/**
+ * Implicit QL on the tridiagonal matrix with diagonal d and off-diagonal
+ * e[i] = T(i, i+1) (e[n-1] unused). On return d holds the eigenvalues in
+ * ascending order and, if V.z is not null, the rows of the transposed
+ * layout have been rotated and permuted to match.
+ */
+void TridiagonalQL(Transposed V, int n, std::vector<double>& d, std::vector<double>& e) {
+    if (n == 0) return;
+    e[n - 1] = 0.0;
+    const double eps = std::numeric_limits<double>::epsilon();
+    double f = 0.0;
+    double tst1 = 0.0;
+
+    for (int l = 0; l < n; l++) {
+        tst1 = std::max(tst1, std::abs(d[l]) + std::abs(e[l]));
+        int m = l;
+        while (m < n - 1 && std::abs(e[m]) > eps * tst1) m++;
+
+        if (m > l) {
+            int iterations = 0;
+            do {
+                if (++iterations > kMaxQLIterations) {
+                    throw std::runtime_error("Eigenvalue iteration did not converge");
+                }
+                // Wilkinson shift from the leading 2x2 block
+                double g = d[l];
+                double p = (d[l + 1] - g) / (2.0 * e[l]);
+                double r = std::hypot(p, 1.0);
+                if (p < 0) r = -r;
+                d[l] = e[l] / (p + r);
+                d[l + 1] = e[l] * (p + r);
+                const double dl1 = d[l + 1];
+                double h = g - d[l];
+                for (int i = l + 2; i < n; i++) d[i] -= h;
+                f += h;
+
+                // Chase the bulge with plane rotations
+                p = d[m];
+                double c = 1.0, c2 = 1.0, c3 = 1.0;
+                const double el1 = e[l + 1];
+                double s = 0.0, s2 = 0.0;
+                for (int i = m - 1; i >= l; i--) {
+                    c3 = c2;
+                    c2 = c;
+                    s2 = s;
+                    g = c * e[i];
+                    h = c * p;
+                    r = std::hypot(p, e[i]);
+                    e[i + 1] = s * r;
+                    s = e[i] / r;
+                    c = p / r;
+                    p = c * d[i] - s * g;
+                    d[i + 1] = h + s * (c * g + s * d[i]);
+                    if (V.z) {
+                        double* vi = V.z + static_cast<std::size_t>(i) * V.ldz;
+                        double* vi1 = V.z + static_cast<std::size_t>(i + 1) * V.ldz;
+                        for (int k = 0; k < n; k++) {
+                            const double t = vi1[k];
+                            vi1[k] = s * vi[k] + c * t;
+                            vi[k] = c * vi[k] - s * t;
+                        }
+                    }
+                }
+                p = -s * s2 * c3 * el1 * e[l] / dl1;
+                e[l] = s * p;
+                d[l] = c * p;
+            } while (std::abs(e[l]) > eps * tst1);
+        }
+        d[l] += f;
+        e[l] = 0.0;
+    }
+
+    // Selection sort keeps the row swaps to at most n - 1
+    for (int i = 0; i < n - 1; i++) {
+        int k = i;
+        for (int j = i + 1; j < n; j++) {
+            if (d[j] < d[k]) k = j;
+        }
+        if (k != i) {
+            std::swap(d[i], d[k]);
+            if (V.z) {
+                std::swap_ranges(V.z + static_cast<std::size_t>(i) * V.ldz,
+                                 V.z + static_cast<std::size_t>(i) * V.ldz + n,
+                                 V.z + static_cast<std::size_t>(k) * V.ldz);
+            }
+        }
+    }
+}
+}
+
+/**
+ * Computes the eigendecomposition of a symmetric matrix
+ * @param A Square symmetric matrix (lower triangle used)
+ * @param computeEigenvectors Skip the vector accumulation in QL when false
+ * @throws std::invalid_argument if A is not square
+ */
+SymmetricEigenSolver::SymmetricEigenSolver(const Matrix& A, bool computeEigenvectors)
+    : mSize(A.GetNumRows()), mEigenvalues(A.GetNumRows()), mEigenvectors(), mHasEigenvectors(computeEigenvectors) {
+    if (!A.IsSquare()) {
+        throw std::invalid_argument("Matrix must be square for the symmetric eigensolver");
+    }
+    const int n = mSize;
+    if (n == 0) return;
+
+    // Transposed layout: fill from the lower triangle, mirrored
+    Matrix Z(n, n);
+    Transposed V = { Z.GetData(), Z.GetStride() };
+    for (int i = 0; i < n; i++) {
+        const double* row = A.GetData() + static_cast<std::size_t>(i) * A.GetStride();
+        for (int j = 0; j <= i; j++) {
+            V(i, j) = row[j];
+            V(j, i) = row[j];
+        }
+    }
+
+    std::vector<double> d(n), e(n);
+    Tridiagonalize(V, n, d, e);
+    for (int i = 1; i < n; i++) e[i - 1] = e[i];
+    Transposed rotations = { computeEigenvectors ? Z.GetData() : nullptr, Z.GetStride() };
+    TridiagonalQL(rotations, n, d, e);
+
+    for (int i = 0; i < n; i++) mEigenvalues[i] = d[i];
+    if (computeEigenvectors) mEigenvectors = Z.Transpose();
+}
+
+int SymmetricEigenSolver::GetSize() const { return mSize; }
+const Vector& SymmetricEigenSolver::GetEigenvalues() const { return mEigenvalues; }
+
+const Matrix& SymmetricEigenSolver::GetEigenvectors() const {
+    if (!mHasEigenvectors) {
+        throw std::logic_error("Eigenvectors were not computed");
+    }
+    return mEigenvectors;
+}
+
+double SymmetricEigenSolver::GetMinEigenvalue() const {
+    if (mSize == 0) throw std::runtime_error("Eigen decomposition is empty");
+    return mEigenvalues[0];
+}
+
+double SymmetricEigenSolver::GetMaxEigenvalue() const {
+    if (mSize == 0) throw std::runtime_error("Eigen decomposition is empty");
+    return mEigenvalues[mSize - 1];
+}
+
+bool SymmetricEigenSolver::IsPositiveDefinite() const {
+    if (mSize == 0) return false;
+    const double largest = std::max(std::abs(GetMinEigenvalue()), std::abs(GetMaxEigenvalue()));
+    return GetMinEigenvalue() > mSize * std::numeric_limits<double>::epsilon() * largest;
+}
+
+double SymmetricEigenSolver::ConditionNumber() const {
+    if (mSize == 0) return 0.0;
+    double smallest = std::numeric_limits<double>::infinity();
+    double largest = 0.0;
+    for (int i = 0; i < mSize; i++) {
+        smallest = std::min(smallest, std::abs(mEigenvalues[i]));
+        largest = std::max(largest, std::abs(mEigenvalues[i]));
+    }
+    if (smallest == 0.0) return std::numeric_limits<double>::infinity();
+    return largest / smallest;
+}
+
+/**
+ * Runs Lanczos until the requested Ritz values at both ends converge
+ * @param A Symmetric operator
+ * @param count Eigenvalues wanted at each end, 1 <= count <= n
+ * @param options Iteration cap, tolerance and seed
+ * @return Ritz values at both ends and convergence information
+ * @throws std::invalid_argument if A is not square or count is out of range
+ */
+LanczosResult LanczosExtremeEigenvalues(const LinearOperator& A, int count, const LanczosOptions& options) {
+    const int n = A.GetNumRows();
+    if (A.GetNumCols() != n) {
+        throw std::invalid_argument("Lanczos requires a square operator");
+    }
+    if (count < 1 || count > n) {
+        throw std::invalid_argument("Eigenvalue count must be between 1 and the operator size");
+    }
+    const int cap = options.maxIterations > 0 ? options.maxIterations : kDefaultLanczosIterations;
+    const int maxSteps = std::min(n, std::max(cap, 2 * count));
+
+    // Krylov basis, one vector per row
+    Matrix Q(maxSteps, n);
+    std::vector<double> alpha, beta;
+    Vector q(n), w(n);
+
+    std::mt19937 generator(options.seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    for (int i = 0; i < n; i++) q[i] = normal(generator);
+    q *= 1.0 / q.Norm();
+
+    LanczosResult result;
+    result.converged = false;
+    std::vector<double> d, e;
+    Matrix S;
+    int k = 0;
+    while (k < maxSteps) {
+        std::copy(q.GetData(), q.GetData() + n, Q.GetData() + static_cast<std::size_t>(k) * Q.GetStride());
+        A.Apply(q, w);
+        alpha.push_back(q * w);
+
+        // Full reorthogonalization against the basis, applied twice
+        for (int pass = 0; pass < 2; pass++) {
+            for (int j = 0; j <= k; j++) {
+                const double* qj = Q.GetData() + static_cast<std::size_t>(j) * Q.GetStride();
+                double dot = 0.0;
+                for (int i = 0; i < n; i++) dot += qj[i] * w[i];
+                for (int i = 0; i < n; i++) w[i] -= dot * qj[i];
+            }
+        }
+        const double b = w.Norm();
+        k++;
+
+        const bool invariant = b <= std::numeric_limits<double>::epsilon() * std::abs(alpha.back()) * n;
+        const bool last = invariant || k == maxSteps;
+        if (k >= 2 * count || last) {
+            if (last || k % kLanczosCheckInterval == 0) {
+                // Ritz values of T_k; the residual of Ritz pair i is |b * S(k-1, i)|
+                d.assign(alpha.begin(), alpha.end());
+                e.assign(beta.begin(), beta.end());
+                e.push_back(0.0);
+                S = Matrix(k, k);
+                for (int i = 0; i < k; i++) S.GetData()[static_cast<std::size_t>(i) * S.GetStride() + i] = 1.0;
+                Transposed rotations = { S.GetData(), S.GetStride() };
+                TridiagonalQL(rotations, k, d, e);
+
+                const double scale = std::max(std::abs(d.front()), std::abs(d.back()));
+                bool converged = true;
+                for (int i = 0; i < count && converged; i++) {
+                    const int ends[2] = { i, k - 1 - i };
+                    for (int end = 0; end < 2; end++) {
+                        const double tail = S.GetData()[static_cast<std::size_t>(ends[end]) * S.GetStride() + k - 1];
+                        if (std::abs(b * tail) > options.tolerance * scale) converged = false;
+                    }
+                }
+                if (converged || invariant || k == n) {
+                    result.converged = true;
+                    break;
+                }
+                if (last) break;
+            }
+        }
+
+        beta.push_back(b);
+        q = w;
+        q *= 1.0 / b;
+    }
+
+    result.iterations = k;
+    const int found = std::min(count, static_cast<int>(d.size()));
+    result.smallest = Vector(found);
+    result.largest = Vector(found);
+    for (int i = 0; i < found; i++) {
+        result.smallest[i] = d[i];
+        result.largest[i] = d[d.size() - 1 - i];
+    }
+    return result;
+}
+
+/**
+ * Estimates the spectral condition number of an SPD operator
+ * @param A Symmetric positive definite operator
+ * @return lambda_max / lambda_min (infinite if lambda_min <= 0)
+ */
+double EstimateConditionNumber(const LinearOperator& A) {
+    const LanczosResult extremes = LanczosExtremeEigenvalues(A, 1);
+    const double smallest = extremes.smallest[0];
+    if (!(smallest > 0.0)) return std::numeric_limits<double>::infinity();
+    return extremes.largest[0] / smallest;
+}
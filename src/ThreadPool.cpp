@@ -0,0 +1,159 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+
+namespace {
+// Chunks per thread, so uneven chunks still balance
+const int kChunksPerThread = 4;
+
+// Set on pool workers and on a dispatching thread while it runs chunks, so
+// nested ParallelFor calls run inline instead of deadlocking
+thread_local bool tInsideParallelRegion = false;
+
+int DefaultNumThreads() {
+    const char* env = std::getenv("TINYPROJECT_NUM_THREADS");
+    if (env) {
+        int n = std::atoi(env);
+        if (n > 0) return n;
+    }
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? static_cast<int>(hw) : 1;
+}
+}
+
+struct ThreadPool::Job {
+    const std::function<void(int, int)>* body;
+    int begin;
+    int end;
+    int chunkSize;
+    int numChunks;
+    std::atomic<int> next;
+    int activeWorkers;                 // Guarded by the pool mutex
+    std::mutex errorMutex;
+    std::exception_ptr error;
+};
+
+ThreadPool::ThreadPool(int numThreads)
+    : mNumThreads(std::max(1, numThreads)), mJob(nullptr), mGeneration(0), mStop(false) {
+    StartWorkers();
+}
+
+ThreadPool::~ThreadPool() {
+    StopWorkers();
+}
+
+ThreadPool& ThreadPool::Global() {
+    static ThreadPool pool(DefaultNumThreads());
+    return pool;
+}
+
+int ThreadPool::GetNumThreads() const { return mNumThreads; }
+
+void ThreadPool::SetNumThreads(int numThreads) {
+    numThreads = std::max(1, numThreads);
+    std::lock_guard<std::mutex> dispatch(mDispatchMutex);
+    if (numThreads == mNumThreads) return;
+    StopWorkers();
+    mNumThreads = numThreads;
+    StartWorkers();
+}
+
+void ThreadPool::StartWorkers() {
+    mStop = false;
+    for (int i = 1; i < mNumThreads; i++) {
+        mWorkers.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+    }
+}
+
+void ThreadPool::StopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWake.notify_all();
+    for (size_t i = 0; i < mWorkers.size(); i++) {
+        mWorkers[i].join();
+    }
+    mWorkers.clear();
+}
+
+void ThreadPool::WorkerLoop() {
+    tInsideParallelRegion = true;
+    std::unique_lock<std::mutex> lock(mMutex);
+    unsigned long seen = mGeneration;
+    while (true) {
+        mWake.wait(lock, [&]() { return mStop || (mJob && mGeneration != seen); });
+        if (mStop) return;
+        seen = mGeneration;
+        Job* job = mJob;
+        job->activeWorkers++;
+        lock.unlock();
+        RunChunks(*job);
+        lock.lock();
+        if (--job->activeWorkers == 0) mDone.notify_all();
+    }
+}
+
+void ThreadPool::RunChunks(Job& job) {
+    while (true) {
+        const int chunk = job.next.fetch_add(1);
+        if (chunk >= job.numChunks) return;
+        const int chunkBegin = job.begin + chunk * job.chunkSize;
+        const int chunkEnd = std::min(job.end, chunkBegin + job.chunkSize);
+        try {
+            (*job.body)(chunkBegin, chunkEnd);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(job.errorMutex);
+            if (!job.error) job.error = std::current_exception();
+        }
+    }
+}
+
+void ThreadPool::ParallelFor(int begin, int end, int minChunk,
+                             const std::function<void(int, int)>& body) {
+    if (end <= begin) return;
+    const int range = end - begin;
+    minChunk = std::max(1, minChunk);
+
+    int numChunks = std::min((range + minChunk - 1) / minChunk, mNumThreads * kChunksPerThread);
+    if (numChunks <= 1 || mNumThreads == 1 || tInsideParallelRegion) {
+        body(begin, end);
+        return;
+    }
+    std::unique_lock<std::mutex> dispatch(mDispatchMutex, std::try_to_lock);
+    if (!dispatch.owns_lock()) {
+        body(begin, end);
+        return;
+    }
+
+    Job job;
+    job.body = &body;
+    job.begin = begin;
+    job.end = end;
+    job.chunkSize = (range + numChunks - 1) / numChunks;
+    job.numChunks = (range + job.chunkSize - 1) / job.chunkSize;
+    job.next = 0;
+    job.activeWorkers = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJob = &job;
+        mGeneration++;
+    }
+    mWake.notify_all();
+
+    tInsideParallelRegion = true;
+    RunChunks(job);
+    tInsideParallelRegion = false;
+
+    {
+        // Workers that picked the job up must release it before it leaves scope
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDone.wait(lock, [&]() { return job.activeWorkers == 0; });
+        mJob = nullptr;
+    }
+
+    if (job.error) std::rethrow_exception(job.error);
+}
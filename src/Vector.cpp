@@ -5,31 +5,35 @@
 
 Vector::Vector() : mSize(0), mData(nullptr) {}
 
-Vector::Vector(int size) : mSize(size) {
-    if (size < 0) {
-        throw std::invalid_argument("Vector size must be non-negative");
-    }
+double* Vector::Allocate(int size) {
     try {
-        mData = new double[size];
-        for (int i = 0; i < size; i++) {
-            mData[i] = 0.0;
-        }
+        return new double[size];
     } catch (const std::bad_alloc& e) {
         throw std::runtime_error("Memory allocation failed: " + std::string(e.what()));
     }
 }
 
-Vector::Vector(const Vector& other) : mSize(other.mSize) {
-    try {
-        mData = new double[mSize];
-        for (int i = 0; i < mSize; i++) {
-            mData[i] = other.mData[i];
-        }
-    } catch (const std::bad_alloc& e) {
-        throw std::runtime_error("Memory allocation failed in copy constructor: " + std::string(e.what()));
+Vector::Vector(int size) : mSize(size), mData(nullptr) {
+    if (size < 0) {
+        throw std::invalid_argument("Vector size must be non-negative");
+    }
+    mData = Allocate(size);
+    for (int i = 0; i < size; i++) {
+        mData[i] = 0.0;
     }
 }
 
+Vector::Vector(const Vector& other) : mSize(other.mSize), mData(Allocate(other.mSize)) {
+    for (int i = 0; i < mSize; i++) {
+        mData[i] = other.mData[i];
+    }
+}
+
+Vector::Vector(Vector&& other) noexcept : mSize(other.mSize), mData(other.mData) {
+    other.mSize = 0;
+    other.mData = nullptr;
+}
+
 Vector::~Vector() {
     delete[] mData;
 }
@@ -56,48 +60,64 @@ const double& Vector::operator[](int i) const {
     return mData[i];
 }
 
+double* Vector::GetData() { return mData; }
+const double* Vector::GetData() const { return mData; }
+
 Vector& Vector::operator=(const Vector& other) {
     if (this != &other) {
-        delete[] mData;
-        mSize = other.mSize;
-        try {
-            mData = new double[mSize];
-            for (int i = 0; i < mSize; i++) mData[i] = other.mData[i];
-        } catch (const std::bad_alloc& e) {
-            throw std::runtime_error("Memory allocation failed in copy assignment: " + std::string(e.what()));
+        // Reallocate only when the size changes
+        if (mSize != other.mSize) {
+            delete[] mData;
+            mData = nullptr;
+            mSize = 0;
+            try {
+                mData = new double[other.mSize];
+            } catch (const std::bad_alloc& e) {
+                throw std::runtime_error("Memory allocation failed in copy assignment: " + std::string(e.what()));
+            }
+            mSize = other.mSize;
         }
+        for (int i = 0; i < mSize; i++) mData[i] = other.mData[i];
     }
     return *this;
 }
 
-Vector Vector::operator+() const { return *this; }
-
-Vector Vector::operator-() const {
-    Vector result(mSize);
-    for (int i = 0; i < mSize; i++) result.mData[i] = -mData[i];
-    return result;
+Vector& Vector::operator=(Vector&& other) noexcept {
+    if (this != &other) {
+        delete[] mData;
+        mSize = other.mSize;
+        mData = other.mData;
+        other.mSize = 0;
+        other.mData = nullptr;
+    }
+    return *this;
 }
 
-Vector Vector::operator+(const Vector& other) const {
+Vector& Vector::operator+=(const Vector& other) {
     if (mSize != other.mSize) throw std::invalid_argument("Vector sizes must match");
-    Vector result(mSize);
-    for (int i = 0; i < mSize; i++) result.mData[i] = mData[i] + other.mData[i];
-    return result;
+    for (int i = 0; i < mSize; i++) mData[i] += other.mData[i];
+    return *this;
 }
 
-Vector Vector::operator-(const Vector& other) const {
+Vector& Vector::operator-=(const Vector& other) {
     if (mSize != other.mSize) throw std::invalid_argument("Vector sizes must match");
-    Vector result(mSize);
-    for (int i = 0; i < mSize; i++) result.mData[i] = mData[i] - other.mData[i];
-    return result;
+    for (int i = 0; i < mSize; i++) mData[i] -= other.mData[i];
+    return *this;
 }
 
-Vector Vector::operator*(double scalar) const {
-    Vector result(mSize);
-    for (int i = 0; i < mSize; i++) result.mData[i] = mData[i] * scalar;
-    return result;
+Vector& Vector::operator*=(double scalar) {
+    for (int i = 0; i < mSize; i++) mData[i] *= scalar;
+    return *this;
 }
 
+Vector& Vector::Axpy(double alpha, const Vector& x) {
+    if (mSize != x.mSize) throw std::invalid_argument("Vector sizes must match");
+    for (int i = 0; i < mSize; i++) mData[i] += alpha * x.mData[i];
+    return *this;
+}
+
+Vector Vector::operator+() const { return *this; }
+
 double Vector::operator*(const Vector& other) const {
     if (mSize != other.mSize) throw std::invalid_argument("Vector sizes must match");
     double result = 0.0;
@@ -114,7 +134,3 @@ void Vector::Print() const {
     for (int i = 0; i < mSize; i++) std::cout << mData[i] << " ";
     std::cout << "]" << std::endl;
 }
-
-Vector operator*(double scalar, const Vector& vec) {
-    return vec * scalar;
-}
\ No newline at end of file